@@ -0,0 +1,36 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace redGrapes
+{
+namespace bench
+{
+
+//! 1, 2, 4, ... up to the number of hardware threads
+inline std::vector< int64_t > thread_counts()
+{
+    int64_t max = std::max( 1u, std::thread::hardware_concurrency() );
+
+    std::vector< int64_t > counts;
+    for( int64_t n = 1; n < max; n *= 2 )
+        counts.push_back( n );
+    counts.push_back( max );
+
+    return counts;
+}
+
+} // namespace bench
+} // namespace redGrapes
+
@@ -0,0 +1,149 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <random>
+#include <vector>
+
+#include <redGrapes/redGrapes.hpp>
+#include <redGrapes/resource/ioresource.hpp>
+#include "common.hpp"
+
+namespace rg = redGrapes;
+
+using IOResource = rg::Resource< rg::access::IOAccess >;
+
+/*
+ * Throughput of task graphs with different shapes.
+ * Each iteration emplaces all tasks and waits until they are removed,
+ * so dependency resolution and scheduling are measured together.
+ *
+ * range(0): number of worker threads
+ * range(1): number of tasks per iteration
+ */
+
+//! every task writes the same resource
+static void chain( benchmark::State & state )
+{
+    rg::init( state.range(0) );
+    rg::IOResource< int > r;
+
+    for( auto _ : state )
+    {
+        for( int64_t i = 0; i < state.range(1); ++i )
+            rg::emplace_task( []( auto r ){ ++ *r; }, r.write() );
+
+        rg::barrier();
+    }
+
+    rg::finalize();
+    state.SetItemsProcessed( state.iterations() * state.range(1) );
+}
+
+//! one writer followed by readers which all depend only on the writer
+static void fan_out( benchmark::State & state )
+{
+    rg::init( state.range(0) );
+    rg::IOResource< int > r;
+
+    for( auto _ : state )
+    {
+        rg::emplace_task( []( auto r ){ ++ *r; }, r.write() );
+        for( int64_t i = 1; i < state.range(1); ++i )
+            rg::emplace_task( []( auto r ){ benchmark::DoNotOptimize( *r ); }, r.read() );
+
+        rg::barrier();
+    }
+
+    rg::finalize();
+    state.SetItemsProcessed( state.iterations() * state.range(1) );
+}
+
+//! independent writers on distinct resources, joined by one task reading all of them
+static void fan_in( benchmark::State & state )
+{
+    unsigned width = 64;
+
+    rg::init( state.range(0) );
+    std::vector< IOResource > resources( width );
+
+    // whole groups of `width` writers and one join
+    int64_t n_groups = ( state.range(1) + width ) / ( width + 1 );
+
+    for( auto _ : state )
+    {
+        for( int64_t g = 0; g < n_groups; ++g )
+        {
+            rg::TaskProperties::Builder join;
+            for( auto & r : resources )
+            {
+                rg::emplace_task(
+                    []{},
+                    rg::TaskProperties::Builder().resources({ r.make_access( rg::access::IOAccess::write ) }) );
+
+                join.add_resource( r.make_access( rg::access::IOAccess::read ) );
+            }
+
+            rg::emplace_task( []{}, std::move( join ) );
+        }
+
+        rg::barrier();
+    }
+
+    rg::finalize();
+    state.SetItemsProcessed( state.iterations() * n_groups * ( width + 1 ) );
+}
+
+//! each task reads or writes one to three out of 16 resources, with a fixed seed
+static void random_dag( benchmark::State & state )
+{
+    unsigned n_resources = 16;
+
+    rg::init( state.range(0) );
+    std::vector< IOResource > resources( n_resources );
+
+    std::mt19937 gen( 42 );
+    std::vector< std::vector< rg::ResourceAccess > > accesses;
+    for( int64_t i = 0; i < state.range(1); ++i )
+    {
+        accesses.emplace_back();
+        unsigned n = 1 + gen() % 3;
+        for( unsigned j = 0; j < n; ++j )
+            accesses.back().push_back(
+                resources[ gen() % n_resources ].make_access(
+                    ( gen() % 4 == 0 ) ? rg::access::IOAccess::write : rg::access::IOAccess::read ) );
+    }
+
+    for( auto _ : state )
+    {
+        for( auto & task_accesses : accesses )
+        {
+            rg::TaskProperties::Builder builder;
+            for( auto & access : task_accesses )
+                builder.add_resource( access );
+
+            rg::emplace_task( []{}, std::move( builder ) );
+        }
+
+        rg::barrier();
+    }
+
+    rg::finalize();
+    state.SetItemsProcessed( state.iterations() * state.range(1) );
+}
+
+#define REDGRAPES_GRAPH_BENCHMARK( name )                               \
+    BENCHMARK( name )                                                   \
+        ->ArgsProduct({ rg::bench::thread_counts(), { 10000 } })        \
+        ->ArgNames({ "threads", "tasks" })                              \
+        ->UseRealTime()                                                 \
+        ->Unit( benchmark::kMillisecond )
+
+REDGRAPES_GRAPH_BENCHMARK( chain );
+REDGRAPES_GRAPH_BENCHMARK( fan_out );
+REDGRAPES_GRAPH_BENCHMARK( fan_in );
+REDGRAPES_GRAPH_BENCHMARK( random_dag );
+
@@ -0,0 +1,15 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <benchmark/benchmark.h>
+
+/*
+ * Results can be written as JSON, e.g.
+ *   ./redGrapes_benchmarks --benchmark_out=results.json --benchmark_out_format=json
+ */
+BENCHMARK_MAIN();
+
@@ -0,0 +1,68 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <redGrapes/redGrapes.hpp>
+#include "common.hpp"
+
+namespace rg = redGrapes;
+
+/*
+ * Spawn rate of tasks without resources and without work,
+ * measured from the first emplacement until all tasks are removed.
+ *
+ * range(0): number of worker threads
+ * range(1): tasks per iteration
+ */
+static void empty_tasks( benchmark::State & state )
+{
+    rg::init( state.range(0) );
+
+    for( auto _ : state )
+    {
+        for( int64_t i = 0; i < state.range(1); ++i )
+            rg::emplace_task( []{} );
+
+        rg::barrier();
+    }
+
+    rg::finalize();
+    state.SetItemsProcessed( state.iterations() * state.range(1) );
+}
+
+BENCHMARK( empty_tasks )
+    ->ArgsProduct({ rg::bench::thread_counts(), { 10000 } })
+    ->ArgNames({ "threads", "tasks" })
+    ->UseRealTime()
+    ->Unit( benchmark::kMillisecond );
+
+/*
+ * Latency from emplacing a single task until its result is available
+ * through Future::get() in the main thread.
+ *
+ * range(0): number of worker threads
+ */
+static void future_roundtrip( benchmark::State & state )
+{
+    rg::init( state.range(0) );
+
+    int x = 0;
+    for( auto _ : state )
+    {
+        x = rg::emplace_task( [x]{ return x + 1; } ).get();
+        benchmark::DoNotOptimize( x );
+    }
+
+    rg::finalize();
+    state.SetItemsProcessed( state.iterations() );
+}
+
+BENCHMARK( future_roundtrip )
+    ->ArgsProduct({ rg::bench::thread_counts() })
+    ->ArgNames({ "threads" })
+    ->UseRealTime()
+    ->Unit( benchmark::kMicrosecond );
+
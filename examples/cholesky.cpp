@@ -3,11 +3,13 @@
 #include <lapacke.h>
 #include <redGrapes/task/property/inherit.hpp>
 #include <redGrapes/task/property/label.hpp>
+#include <redGrapes/task/property/priority.hpp>
 
-#define REDGRAPES_TASK_PROPERTIES redGrapes::LabelProperty
+#define REDGRAPES_TASK_PROPERTIES redGrapes::LabelProperty, redGrapes::PriorityProperty
 
 #include <redGrapes/redGrapes.hpp>
 #include <redGrapes/resource/ioresource.hpp>
+#include <redGrapes/scheduler/priority_scheduler.hpp>
 
 namespace rg = redGrapes;
 
@@ -34,7 +36,12 @@ int main(int argc, char* argv[])
     if(argc >= 4)
         n_threads = atoi(argv[3]);
 
-    rg::init(n_threads);
+    // the panel (potrf, trsm) is on the critical path, so it goes first
+    rg::init(std::make_shared<rg::scheduler::PriorityScheduler<>>(
+        n_threads,
+        rg::dispatch::thread::IdlePolicy(),
+        rg::dispatch::thread::PinningPolicy::COMPACT,
+        4));
 
     size_t N = nblks * blksz;
 
@@ -85,7 +92,7 @@ int main(int argc, char* argv[])
                         cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans,
                                     blksz, blksz, blksz, -1.0, *a, blksz, *b, blksz, 1.0, *c, blksz);
                     },
-                    rg::TaskProperties::Builder().label("gemm"),
+                    rg::TaskProperties::Builder().label("gemm").priority(0),
                     A[k * nblks + i].read(),
                     A[k * nblks + j].read(),
                     A[j * nblks + i].write());
@@ -102,6 +109,7 @@ int main(int argc, char* argv[])
                     cblas_dsyrk(CblasColMajor, CblasLower, CblasNoTrans,
                                 blksz, blksz, -1.0, *a, blksz, 1.0, *c, blksz);
                 },
+                rg::TaskProperties::Builder().label("syrk").priority(1),
                 A[i * nblks + j].read(),
                 A[j * nblks + j].write());
         }
@@ -113,6 +121,7 @@ int main(int argc, char* argv[])
                 spdlog::info("dpotrf");
                 LAPACKE_dpotrf(LAPACK_COL_MAJOR, 'L', blksz, *a, blksz);
             },
+            rg::TaskProperties::Builder().label("potrf").priority(3),
             A[j * nblks + j].write());
 
         for(size_t i = j + 1; i < nblks; i++)
@@ -126,6 +135,7 @@ int main(int argc, char* argv[])
                                 CblasRight, CblasLower, CblasTrans, CblasNonUnit,
                                 blksz, blksz, 1.0, *a, blksz, *b, blksz);
                 },
+                rg::TaskProperties::Builder().label("trsm").priority(2),
                 A[j * nblks + j].read(),
                 A[j * nblks + i].write());
         }
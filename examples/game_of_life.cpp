@@ -15,6 +15,7 @@
 #include <random>
 #include <thread>
 
+#include <redGrapes/parallel_for.hpp>
 #include <redGrapes/redGrapes.hpp>
 #include <redGrapes/resource/fieldresource.hpp>
 #include <redGrapes/resource/ioresource.hpp>
@@ -24,7 +25,7 @@
 struct Vec2 { int x, y; };
 enum Cell { DEAD, ALIVE };
 static constexpr Vec2 size { 32, 32 };
-static constexpr Vec2 chunk_size { 4, 4 };
+static constexpr size_t chunk_rows = 4;
 
 Cell next_state( Cell const neighbours [][size.x+2] )
 {
@@ -114,19 +115,16 @@ int main( int, char * [] )
             buffers[current].read()
          ).get();
 
-        // calculate next step
-        for ( size_t x = 1; x <= size.x; x += chunk_size.x )
-            for ( size_t y = 1; y <= size.y; y += chunk_size.y )
-                redGrapes::emplace_task(
-                    [x, y]( auto dst, auto src )
-                    {
-                        for ( int xi = 0; xi < chunk_size.x; ++xi )
-                            for ( int yi = 0; yi < chunk_size.y; ++yi )
-                                dst[{x+xi, y+yi}] = next_state( (Cell const (*)[size.x+2]) &(src[{x+xi, y+yi}]) );
-                    },
-                    buffers[next].write().area({x, y}, {x + chunk_size.x, y + chunk_size.y}),
-                    buffers[current].read().area({x-1, y-1}, {x+chunk_size.x+2, y + chunk_size.y+2})
-                );
+        // calculate next step, in tiles of `chunk_rows` rows
+        redGrapes::parallel_for(
+            buffers[next].write().area({1, 1}, {size.x + 1, size.y + 1}),
+            []( auto index, Cell & cell, auto src )
+            {
+                cell = next_state( (Cell const (*)[size.x+2]) &(src[index]) );
+            },
+            chunk_rows,
+            buffers[current].read()
+        );
 
         current = next;
     }
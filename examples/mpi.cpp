@@ -143,7 +143,7 @@ int main()
 
                 mpi_request_pool->get_status( request );
             },
-            rg::TaskProperties::Builder().scheduling_tags({ SCHED_MPI }),
+            rg::TaskProperties::Builder().scheduling_tags({ SCHED_MPI }).may_yield(),
             field[current].at({3}).read(),
             mpi_config.read()
         );
@@ -162,7 +162,7 @@ int main()
                 int recv_data_count;
                 MPI_Get_count( &status, MPI_CHAR, &recv_data_count );
             },
-            rg::TaskProperties::Builder().scheduling_tags({ SCHED_MPI }),
+            rg::TaskProperties::Builder().scheduling_tags({ SCHED_MPI }).may_yield(),
             field[current].at({0}).write(),
             mpi_config.read()
         );
@@ -170,15 +170,19 @@ int main()
         /*
          * Compute iteration
          */
-        for( size_t i = 1; i < field[current]->size(); ++i )
-            rg::emplace_task(
-                [i]( auto dst, auto src )
-                {
-                    dst[{i}] = src[{i - 1}];
-                },
-                field[next].at({i}).write(),
-                field[current].at({i-1}).read()
-            );
+        rg::emplace_task_range(
+            size_t(1), field[current]->size(),
+            []( size_t i, auto dst, auto src )
+            {
+                dst[{i}] = src[{i - 1}];
+            },
+            [&]( size_t i )
+            {
+                return std::make_tuple(
+                    field[next].at({i}).write(),
+                    field[current].at({i-1}).read() );
+            }
+        );
 
         /*
          * Write Output
@@ -13,6 +13,8 @@ struct TaskSpace;
 
 /*! global context
  */
+
+//! task spaces which have emplaced but not yet initialized tasks
 extern moodycamel::ConcurrentQueue< std::shared_ptr<TaskSpace> > active_task_spaces;
 extern std::shared_ptr< TaskSpace > top_space;
 extern std::shared_ptr< scheduler::IScheduler > top_scheduler;
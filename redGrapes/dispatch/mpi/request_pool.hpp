@@ -78,6 +78,8 @@ struct RequestPool
      * Adds a new MPI request to the pool and
      * yields until the request is done. While waiting
      * for this request, other tasks will be executed.
+     * The calling task should have the `may_yield` property,
+     * otherwise it blocks its thread until the request is done.
      *
      * @param request The MPI request to wait for
      * @return the resulting MPI status of the request
@@ -9,8 +9,14 @@
 #include <spdlog/spdlog.h>
 
 #include <redGrapes/scheduler/event.hpp>
+#include <redGrapes/scheduler/rank.hpp>
 #include <redGrapes/task/task.hpp>
+#include <redGrapes/task/task_space.hpp>
 #include <redGrapes/context.hpp>
+#include <redGrapes/dispatch/thread/worker.hpp>
+#include <redGrapes/trace/counters.hpp>
+#include <redGrapes/trace/profiler.hpp>
+#include <redGrapes/trace/tracer.hpp>
 
 namespace redGrapes
 {
@@ -19,25 +25,171 @@ namespace dispatch
 namespace thread
 {
 
+thread_local WorkerThread * current_worker;
+thread_local std::shared_ptr< WorkerThread > current_worker_keepalive;
+
+/*! time the innermost executing task spent in WorkerThread::wait_for(),
+ *  including the tasks executed on top of it
+ */
+static thread_local uint64_t paused_ns;
+
+//! true if task was emplaced by ancestor or one of its descendants
+static bool is_descendant( Task const & task, Task const * ancestor )
+{
+    for( Task const * parent = task.space->parent; parent; parent = parent->space->parent )
+        if( parent == ancestor )
+            return true;
+
+    return false;
+}
+
 void execute_task( Task & task )
+{
+    execute_task( task, task.may_yield );
+}
+
+void execute_task( Task & task, bool may_yield )
 {
     SPDLOG_TRACE("thread dispatch: execute task {}", task.task_id);
     assert( task.is_ready() );
 
     task.get_pre_event().notify();
+
+    // a waiting task without its own stack may execute other tasks on top of it
+    Task * outer_task = current_task;
     current_task = &task;
 
-    if( auto event = task() )
+    trace::ThreadCounters & counters = trace::counters();
+    if( task.is_started() )
     {
-        task.sg_pause( *event );
+        trace::ThreadCounters::add( counters.resumes );
+        trace::record( trace::EventKind::RESUME, task.task_id );
+    }
+    else
+    {
+        trace::record( trace::EventKind::START, task.task_id );
+        scheduler::rank::record_start( task );
+    }
+
+    uint64_t begin = profiler::enabled() ? profiler::now() : 0;
+    uint64_t rank_begin = scheduler::rank::enabled() ? trace::now_ns() : 0;
+
+    uint64_t outer_paused_ns = paused_ns;
+    paused_ns = 0;
+
+    auto event = task( may_yield );
 
-        task.pre_event.up();
+    // a stackless wait is a pause like a yield, so it is not execution time
+    profiler::record_execution( task.task_id, begin + paused_ns );
+    scheduler::rank::record_execution( task, rank_begin + paused_ns, ! event );
+    paused_ns = outer_paused_ns;
+
+    if( event )
+    {
+        trace::ThreadCounters::add( counters.yields );
+        trace::record( trace::EventKind::YIELD, task.task_id );
+        task.sg_pause( *event );
         task.get_pre_event().notify();
     }
     else
+    {
+        trace::ThreadCounters::add( counters.tasks_executed );
+        trace::record( trace::EventKind::FINISH, task.task_id );
+        if( current_worker )
+            task.mark_written( current_worker->id );
         task.get_post_event().notify();
+    }
+
+    current_task = outer_task;
+}
+
+//! execute task on top of the waiting current task, see execute_ready_task()
+static void execute_nested( Task & task )
+{
+    execute_task(
+        task,
+        task.may_yield || ( current_task && ! is_descendant( task, current_task ) ) );
+}
+
+bool execute_ready_task()
+{
+    if( ! current_worker )
+        return false;
+
+    if( Task * task = current_worker->get_scheduler()->get_job() )
+    {
+        execute_nested( *task );
+        return true;
+    }
+
+    return false;
+}
+
+void WorkerThread::wait_for( scheduler::EventPtr event )
+{
+    uint64_t begin = trace::now_ns();
+    trace::ThreadCounters & counters = trace::counters();
+
+    while( ! event->is_reached() )
+    {
+        if( execute_ready_task() )
+            continue;
+
+        bool progress = false;
+        for( unsigned i = 0; i < idle_policy.spin_iterations && ! progress; ++i )
+        {
+            cpu_relax();
+            if( event->is_reached() || execute_ready_task() )
+            {
+                trace::ThreadCounters::add( counters.spin_hits );
+                progress = true;
+            }
+        }
+
+        for( unsigned i = 0; i < idle_policy.yield_iterations && ! progress; ++i )
+        {
+            std::this_thread::yield();
+            if( event->is_reached() || execute_ready_task() )
+            {
+                trace::ThreadCounters::add( counters.yield_hits );
+                progress = true;
+            }
+        }
+
+        if( progress )
+            continue;
+
+        // only one worker can be woken by the event,
+        // any further one waiting for it keeps polling
+        WorkerThread * no_waiter = nullptr;
+        if( ! event->waiter.compare_exchange_strong( no_waiter, this ) )
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        if( sleepers )
+            sleepers->push( *this );
+
+        // the event or new work may have arrived right before we registered
+        Task * task = nullptr;
+        if( ! event->is_reached() && ! ( task = scheduler->get_job() ) )
+        {
+            SPDLOG_TRACE("Worker Thread: park in stackless wait");
+            trace::ThreadCounters::add( counters.parks );
+            std::unique_lock< std::mutex > l( m );
+            cv.wait( l, [this]{ return !wait.test_and_set(); } );
+        }
+
+        if( sleepers )
+            sleepers->remove( *this );
+        event->waiter = nullptr;
+
+        if( task )
+            execute_nested( *task );
+    }
 
-    current_task = nullptr;
+    paused_ns += trace::now_ns() - begin;
 }
 
 } // namespace thread
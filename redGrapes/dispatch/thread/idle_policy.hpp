@@ -0,0 +1,70 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+ * @file redGrapes/dispatch/thread/idle_policy.hpp
+ */
+
+#pragma once
+
+namespace redGrapes
+{
+namespace dispatch
+{
+namespace thread
+{
+
+//! hint to the cpu that we are in a busy-wait loop
+inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield");
+#endif
+}
+
+/*!
+ * Configures what a worker thread does when it runs out of jobs.
+ *
+ * The worker first polls for new jobs `spin_iterations` times,
+ * pausing the cpu in between, then `yield_iterations` times
+ * while yielding its time slice to the OS, and only after that it
+ * parks (sleeps until it gets notified).
+ *
+ * The default parks immediately, which costs a full sleep/wake cycle
+ * for every gap in the task stream but does not burn any cpu time.
+ *
+ * stats() counts how often each phase found work.
+ */
+struct IdlePolicy
+{
+    unsigned spin_iterations;
+    unsigned yield_iterations;
+
+    IdlePolicy( unsigned spin_iterations = 0, unsigned yield_iterations = 0 )
+        : spin_iterations( spin_iterations )
+        , yield_iterations( yield_iterations )
+    {}
+
+    //! sleep as soon as no job is available
+    static IdlePolicy park()
+    {
+        return IdlePolicy( 0, 0 );
+    }
+
+    //! trade some cpu time for microsecond-level task pickup
+    static IdlePolicy spin_then_park()
+    {
+        return IdlePolicy( 4096, 64 );
+    }
+};
+
+} // namespace thread
+} // namespace dispatch
+} // namespace redGrapes
+
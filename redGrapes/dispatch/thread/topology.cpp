@@ -0,0 +1,299 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <sched.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+#include <redGrapes/dispatch/thread/topology.hpp>
+#include <redGrapes/dispatch/thread/worker.hpp>
+
+namespace redGrapes
+{
+namespace dispatch
+{
+namespace thread
+{
+
+static bool read_line( std::string const & path, std::string & line )
+{
+    std::ifstream f( path );
+    return f && std::getline( f, line );
+}
+
+std::vector< unsigned > Topology::parse_cpulist( std::string const & list )
+{
+    std::vector< unsigned > cpus;
+    std::stringstream s( list );
+    std::string range;
+
+    while( std::getline( s, range, ',' ) )
+    {
+        if( range.empty() || range == "\n" )
+            continue;
+
+        try
+        {
+            size_t dash = range.find( '-' );
+            unsigned first = std::stoul( range.substr( 0, dash ) );
+            unsigned last = ( dash == std::string::npos ) ? first : std::stoul( range.substr( dash + 1 ) );
+
+            for( unsigned cpu = first; cpu <= last; ++cpu )
+                cpus.push_back( cpu );
+        }
+        catch( std::exception const & )
+        {
+            spdlog::warn( "Topology: invalid cpu list \"{}\"", list );
+        }
+    }
+
+    std::sort( cpus.begin(), cpus.end() );
+    cpus.erase( std::unique( cpus.begin(), cpus.end() ), cpus.end() );
+    return cpus;
+}
+
+Topology::Topology( std::vector< std::vector< unsigned > > node_cpus_ )
+    : node_cpus( std::move( node_cpus_ ) )
+{
+    for( unsigned node = 0; node < node_cpus.size(); ++node )
+        for( unsigned cpu : node_cpus[ node ] )
+        {
+            if( cpu >= cpu_node.size() )
+                cpu_node.resize( cpu + 1, 0 );
+            cpu_node[ cpu ] = node;
+        }
+}
+
+Topology Topology::discover( std::string const & sysfs )
+{
+    std::vector< std::vector< unsigned > > node_cpus;
+    std::string line;
+
+    std::vector< unsigned > online;
+    if( read_line( sysfs + "/cpu/online", line ) )
+        online = parse_cpulist( line );
+    else
+        for( unsigned cpu = 0; cpu < std::max( 1u, std::thread::hardware_concurrency() ); ++cpu )
+            online.push_back( cpu );
+
+    std::vector< unsigned > nodes;
+    if( read_line( sysfs + "/node/online", line ) )
+        nodes = parse_cpulist( line );
+
+    for( unsigned node : nodes )
+        if( read_line( sysfs + "/node/node" + std::to_string( node ) + "/cpulist", line ) )
+        {
+            std::vector< unsigned > cpus;
+            for( unsigned cpu : parse_cpulist( line ) )
+                if( std::binary_search( online.begin(), online.end(), cpu ) )
+                    cpus.push_back( cpu );
+
+            // memory-only nodes have no cpus
+            if( ! cpus.empty() )
+                node_cpus.push_back( cpus );
+        }
+
+    if( node_cpus.empty() )
+        node_cpus.push_back( online );
+
+    return Topology( std::move( node_cpus ) );
+}
+
+Topology const & Topology::get()
+{
+    static Topology topology = discover();
+    return topology;
+}
+
+std::vector< unsigned > const & Topology::affinity()
+{
+    static std::vector< unsigned > cpus = []
+    {
+        std::vector< unsigned > cpus;
+
+        cpu_set_t cpuset;
+        CPU_ZERO( &cpuset );
+        if( sched_getaffinity( 0, sizeof(cpu_set_t), &cpuset ) == 0 )
+        {
+            for( unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu )
+                if( CPU_ISSET( cpu, &cpuset ) )
+                    cpus.push_back( cpu );
+        }
+        else
+            spdlog::warn( "Topology: sched_getaffinity failed, using all online cpus" );
+
+        return cpus;
+    }();
+
+    return cpus;
+}
+
+Topology const & Topology::available()
+{
+    static Topology topology = affinity().empty()
+        ? get()
+        : get().restrict_to( affinity() );
+    return topology;
+}
+
+Topology Topology::restrict_to( std::vector< unsigned > const & cpus ) const
+{
+    std::vector< std::vector< unsigned > > restricted;
+    for( auto & node : node_cpus )
+    {
+        restricted.emplace_back();
+        for( unsigned cpu : node )
+            if( std::find( cpus.begin(), cpus.end(), cpu ) != cpus.end() )
+                restricted.back().push_back( cpu );
+    }
+
+    return Topology( std::move( restricted ) );
+}
+
+unsigned Topology::n_cpus() const
+{
+    unsigned n = 0;
+    for( auto & cpus : node_cpus )
+        n += cpus.size();
+    return n;
+}
+
+unsigned Topology::node_of( unsigned cpu ) const
+{
+    return ( cpu < cpu_node.size() ) ? cpu_node[ cpu ] : 0;
+}
+
+unsigned Topology::current_node() const
+{
+    if( n_nodes() <= 1 )
+        return 0;
+
+    int cpu = sched_getcpu();
+    return ( cpu >= 0 ) ? node_of( cpu ) : 0;
+}
+
+Placement place_workers( Topology const & topology, size_t n_workers, PinningPolicy policy )
+{
+    Placement p;
+    p.worker_cpus.resize( n_workers );
+    p.worker_node.resize( n_workers, 0 );
+
+    if( topology.n_cpus() == 0 )
+        return p;
+
+    if( policy == PinningPolicy::NONE )
+    {
+        std::vector< unsigned > all;
+        for( auto & cpus : topology.node_cpus )
+            all.insert( all.end(), cpus.begin(), cpus.end() );
+        std::sort( all.begin(), all.end() );
+
+        std::fill( p.worker_cpus.begin(), p.worker_cpus.end(), all );
+        return p;
+    }
+
+    // nodes which have cpus left
+    std::vector< unsigned > nodes;
+    for( unsigned node = 0; node < topology.n_nodes(); ++node )
+        if( ! topology.node_cpus[ node ].empty() )
+            nodes.push_back( node );
+
+    if( policy == PinningPolicy::NODE )
+    {
+        p.main_cpus = topology.node_cpus[ nodes[ 0 ] ];
+        for( size_t i = 0; i < n_workers; ++i )
+        {
+            p.worker_node[ i ] = nodes[ ( i * nodes.size() ) / n_workers ];
+            p.worker_cpus[ i ] = topology.node_cpus[ p.worker_node[ i ] ];
+        }
+        return p;
+    }
+
+    // sequence of cpus the main thread and the workers take in turn
+    std::vector< unsigned > slots;
+    if( policy == PinningPolicy::COMPACT )
+    {
+        for( auto & cpus : topology.node_cpus )
+            slots.insert( slots.end(), cpus.begin(), cpus.end() );
+    }
+    else
+    {
+        for( size_t k = 0; slots.size() < topology.n_cpus(); ++k )
+            for( auto & cpus : topology.node_cpus )
+                if( k < cpus.size() )
+                    slots.push_back( cpus[ k ] );
+    }
+
+    p.main_cpus = { slots[ 0 ] };
+    for( size_t i = 0; i < n_workers; ++i )
+    {
+        unsigned cpu = slots[ ( i + 1 ) % slots.size() ];
+        p.worker_cpus[ i ] = { cpu };
+        p.worker_node[ i ] = topology.node_of( cpu );
+    }
+
+    return p;
+}
+
+Placement place_workers( size_t n_workers, PinningPolicy policy )
+{
+    Topology const & topology = Topology::available();
+
+    if( policy != PinningPolicy::NONE && n_workers > topology.n_cpus() )
+        spdlog::warn(
+            "place_workers: {} workers on {} available cpus, "
+            "consider fewer workers or PinningPolicy::NONE",
+            n_workers,
+            topology.n_cpus() );
+
+    return place_workers( topology, n_workers, policy );
+}
+
+size_t default_n_workers()
+{
+    unsigned n_cpus = Topology::available().n_cpus();
+    return ( n_cpus > 1 ) ? n_cpus - 1 : 1;
+}
+
+bool pin_thread( pthread_t thread, std::vector< unsigned > const & cpus )
+{
+    if( cpus.empty() )
+        return true;
+
+    cpu_set_t cpuset;
+    CPU_ZERO( &cpuset );
+    for( unsigned cpu : cpus )
+        if( cpu < CPU_SETSIZE )
+            CPU_SET( cpu, &cpuset );
+
+    if( int rc = pthread_setaffinity_np( thread, sizeof(cpu_set_t), &cpuset ) )
+    {
+        spdlog::warn( "pin_thread: pthread_setaffinity_np failed: {}", std::strerror( rc ) );
+        return false;
+    }
+
+    return true;
+}
+
+void pin_workers(
+    std::vector< std::shared_ptr< WorkerThread > > const & workers,
+    Placement const & placement )
+{
+    pin_thread( pthread_self(), placement.main_cpus );
+    for( size_t i = 0; i < workers.size() && i < placement.worker_cpus.size(); ++i )
+        pin_thread( workers[ i ]->thread.native_handle(), placement.worker_cpus[ i ] );
+}
+
+} // namespace thread
+} // namespace dispatch
+} // namespace redGrapes
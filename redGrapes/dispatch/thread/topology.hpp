@@ -0,0 +1,143 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+ * @file redGrapes/dispatch/thread/topology.hpp
+ */
+
+#pragma once
+
+#include <pthread.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace redGrapes
+{
+namespace dispatch
+{
+namespace thread
+{
+
+struct WorkerThread;
+
+/*!
+ * Online CPUs of the machine, grouped by NUMA node.
+ *
+ * Read from /sys/devices/system, machines without NUMA information
+ * have a single node with all online CPUs.
+ */
+struct Topology
+{
+    Topology() = default;
+
+    explicit Topology( std::vector< std::vector< unsigned > > node_cpus );
+
+    //! ids of the CPUs of each node, in ascending order
+    std::vector< std::vector< unsigned > > node_cpus;
+
+    unsigned n_nodes() const
+    {
+        return node_cpus.size();
+    }
+
+    unsigned n_cpus() const;
+
+    //! @return node of the given CPU, 0 if unknown
+    unsigned node_of( unsigned cpu ) const;
+
+    //! @return node of the CPU the calling thread currently runs on
+    unsigned current_node() const;
+
+    /*! parse a CPU list as used by sysfs, e.g. "0-3,8,10-11"
+     *  @return CPU ids in ascending order
+     */
+    static std::vector< unsigned > parse_cpulist( std::string const & list );
+
+    //! @param sysfs directory which contains cpu/ and node/
+    static Topology discover( std::string const & sysfs = "/sys/devices/system" );
+
+    //! topology of this machine, discovered once
+    static Topology const & get();
+
+    /*! CPUs in the affinity mask of the process (e.g. a cpuset of the
+     *  batch system), read at the first call, i.e. before any scheduler
+     *  pinned the main thread
+     */
+    static std::vector< unsigned > const & affinity();
+
+    //! the topology of this machine restricted to affinity()
+    static Topology const & available();
+
+    /*! only the given CPUs, nodes keep their index
+     *  and may end up without any CPU
+     */
+    Topology restrict_to( std::vector< unsigned > const & cpus ) const;
+
+private:
+    //! node of each CPU id
+    std::vector< unsigned > cpu_node;
+};
+
+//! how the worker threads of a scheduler are pinned to CPUs
+enum class PinningPolicy
+{
+    /*! main thread and workers on consecutive CPUs,
+     *  filling one node after the other
+     */
+    COMPACT,
+
+    //! consecutive workers on alternating nodes, one CPU each
+    SCATTER,
+
+    /*! workers split into one contiguous block per node,
+     *  each worker may run on all CPUs of its node
+     */
+    NODE,
+
+    /*! every worker may run on all available CPUs and the main thread
+     *  is left alone, e.g. when several processes share the CPUs
+     */
+    NONE
+};
+
+//! CPUs of the main thread and of each worker
+struct Placement
+{
+    std::vector< unsigned > main_cpus;
+    std::vector< std::vector< unsigned > > worker_cpus;
+
+    //! NUMA node of each worker
+    std::vector< unsigned > worker_node;
+};
+
+/*! spread workers over the CPUs of a topology,
+ *  if there are more workers than CPUs they wrap around
+ */
+Placement place_workers( Topology const & topology, size_t n_workers, PinningPolicy policy );
+
+//! place workers on the CPUs available to this process
+Placement place_workers( size_t n_workers, PinningPolicy policy );
+
+/*! default number of worker threads, one per available CPU
+ *  except the one which place_workers() gives to the main thread
+ */
+size_t default_n_workers();
+
+/*! restrict a thread to a set of CPUs, no-op for an empty set
+ *  @return false if the affinity could not be set
+ */
+bool pin_thread( pthread_t thread, std::vector< unsigned > const & cpus );
+
+//! pin the calling (main) thread and the workers of a scheduler
+void pin_workers(
+    std::vector< std::shared_ptr< WorkerThread > > const & workers,
+    Placement const & placement );
+
+} // namespace thread
+} // namespace dispatch
+} // namespace redGrapes
@@ -11,10 +11,15 @@
 #include <atomic>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <vector>
+#include <algorithm>
 #include <condition_variable>
 
 #include <redGrapes/scheduler/event.hpp>
+#include <redGrapes/dispatch/thread/idle_policy.hpp>
 #include <redGrapes/task/task.hpp>
+#include <redGrapes/trace/counters.hpp>
 #include <redGrapes/context.hpp>
 
 namespace redGrapes
@@ -26,6 +31,70 @@ namespace thread
 
 void execute_task( Task & task );
 
+/*! execute task on the current thread
+ * @param may_yield run the task on a fiber even if it has no may_yield,
+ *                  see TaskBase::operator()
+ */
+void execute_task( Task & task, bool may_yield );
+
+/*! execute one ready task of the current worker on the current stack,
+ *  used by tasks without may_yield while they wait for an event.
+ *
+ *  Only descendants of the waiting task run stackless on top of it.
+ *  Any other task could wait for something that needs the waiting
+ *  task to return first, so it gets a fiber and yields instead.
+ *
+ * @return false if this is no worker thread or no task is ready
+ */
+bool execute_ready_task();
+
+struct WorkerThread;
+
+//! the worker thread which is executing the current thread, nullptr if none
+extern thread_local WorkerThread * current_worker;
+
+/*!
+ * Stack of sleeping worker threads.
+ *
+ * Workers register themselves before going to sleep,
+ * so that producers of work can wake up exactly one of them
+ * and never need to touch busy workers.
+ */
+struct SleeperRegistry
+{
+    SleeperRegistry()
+        : n_sleeping( 0 )
+    {}
+
+    //! register worker as sleeping, no-op if already registered
+    void push( WorkerThread & worker );
+
+    //! unregister worker if it is still registered
+    void remove( WorkerThread & worker );
+
+    /*! wake up the most recently registered sleeper
+     * @return true if a worker was woken
+     */
+    bool wake_one();
+
+    /*! wake up the worker with the given id if it is sleeping
+     * @return true if it was woken
+     */
+    bool wake( unsigned worker_id );
+
+    void wake_all();
+
+    unsigned count() const
+    {
+        return n_sleeping.load( std::memory_order_relaxed );
+    }
+
+private:
+    std::mutex m;
+    std::vector< WorkerThread * > sleeping;
+    std::atomic< unsigned > n_sleeping;
+};
+
 /*!
  * Creates a thread which repeatedly calls consume()
  * until stop() is invoked or the object destroyed.
@@ -48,20 +117,46 @@ private:
     std::mutex m;
     std::condition_variable cv;
 
+    //! may be null, then the worker must be notified explicitly
+    std::shared_ptr< SleeperRegistry > sleepers;
+
+    IdlePolicy idle_policy;
+
+    friend struct SleeperRegistry;
+    //! true while this worker is on the stack of `sleepers`, guarded by its mutex
+    bool registered;
+
 public:
+    //! index of this worker inside its pool
+    unsigned id;
+
     std::thread thread;
 
 public:
     /*!
-     * @param consume function that executes a task if possible and returns
-     *                if any work is left
+     * @param scheduler scheduler whose jobs this worker executes
+     * @param id index of this worker inside its pool
+     * @param sleepers registry this worker registers at before parking,
+     *                 nullptr if it is only woken up directly
+     * @param idle_policy how long to spin and yield before parking
      */
-    WorkerThread( std::shared_ptr< scheduler::IScheduler > scheduler ) :
+    WorkerThread(
+        std::shared_ptr< scheduler::IScheduler > scheduler,
+        unsigned id = 0,
+        std::shared_ptr< SleeperRegistry > sleepers = nullptr,
+        IdlePolicy idle_policy = IdlePolicy()
+    ) :
         m_stop( false ),
         scheduler( scheduler ),
+        sleepers( sleepers ),
+        idle_policy( idle_policy ),
+        registered( false ),
+        id( id ),
         thread(
             [this]
             {
+                current_worker = this;
+
                 /* since we are in a worker, there should always
                  * be a task running (we always have a parent task
                  * and therefore yield() guarantees to do
@@ -73,12 +168,47 @@ public:
                         throw std::runtime_error("idle in worker thread!");
                     };
 
+                trace::ThreadCounters & counters = trace::counters();
+
                 while( ! m_stop )
                 {
+                    // out of jobs from here on
+                    uint64_t idle_begin = trace::now_ns();
+                    auto end_idle = [&counters, idle_begin]
+                    {
+                        trace::ThreadCounters::add( counters.idle_ns, trace::now_ns() - idle_begin );
+                    };
+
+                    if( auto task = poll() )
+                    {
+                        end_idle();
+                        do
+                            dispatch::thread::execute_task( *task );
+                        while( (task = this->scheduler->get_job()) );
+
+                        continue;
+                    }
+
+                    if( this->sleepers )
+                    {
+                        this->sleepers->push( *this );
+
+                        // work may have been activated right before we registered
+                        if( auto task = this->scheduler->get_job() )
+                        {
+                            end_idle();
+                            this->sleepers->remove( *this );
+                            dispatch::thread::execute_task( *task );
+                            continue;
+                        }
+                    }
+
                     SPDLOG_TRACE("Worker Thread: sleep");
+                    trace::ThreadCounters::add( counters.parks );
                     std::unique_lock< std::mutex > l( m );
                     cv.wait( l, [this]{ return !wait.test_and_set(); } );
                     l.unlock();
+                    end_idle();
 
                     while( auto task = this->scheduler->get_job() )
                         dispatch::thread::execute_task( *task );
@@ -92,9 +222,23 @@ public:
     ~WorkerThread()
     {
         stop();
-        thread.join();
+
+        // see stop_workers()
+        if( thread.get_id() == std::this_thread::get_id() )
+            thread.detach();
+        else
+            thread.join();
+
+        // a worker stopped while parked is still registered
+        if( sleepers )
+            sleepers->remove( *this );
     }
     
+    std::shared_ptr< scheduler::IScheduler > const & get_scheduler() const
+    {
+        return scheduler;
+    }
+
     void notify()
     {
         std::unique_lock< std::mutex > l( m );
@@ -104,6 +248,46 @@ public:
         cv.notify_one();
     }
 
+    /*! wait on this worker until event is reached,
+     *  executing ready tasks in the meantime (see execute_ready_task()).
+     *  Without work it spins, yields and parks like the worker loop,
+     *  parked it is woken by the event or by new work.
+     *  The time spent here is not charged to the waiting task.
+     */
+    void wait_for( scheduler::EventPtr event );
+
+private:
+    /*! busy-wait for a job according to the idle policy
+     * @return job or nullptr if the worker should park
+     */
+    Task * poll()
+    {
+        trace::ThreadCounters & counters = trace::counters();
+
+        for( unsigned i = 0; i < idle_policy.spin_iterations && ! m_stop; ++i )
+        {
+            cpu_relax();
+            if( auto task = scheduler->get_job() )
+            {
+                trace::ThreadCounters::add( counters.spin_hits );
+                return task;
+            }
+        }
+
+        for( unsigned i = 0; i < idle_policy.yield_iterations && ! m_stop; ++i )
+        {
+            std::this_thread::yield();
+            if( auto task = scheduler->get_job() )
+            {
+                trace::ThreadCounters::add( counters.yield_hits );
+                return task;
+            }
+        }
+
+        return nullptr;
+    }
+
+public:
     void stop()
     {
         SPDLOG_TRACE("Worker::stop()");
@@ -112,6 +296,124 @@ public:
     }
 };
 
+/*! keeps the current worker alive until its thread exits,
+ * in case its pool got destroyed from inside the worker itself
+ */
+extern thread_local std::shared_ptr< WorkerThread > current_worker_keepalive;
+
+/*!
+ * Stop all workers of a pool and join them.
+ *
+ * The last reference to a scheduler may be dropped inside one of
+ * its own workers (e.g. right after the last task was removed).
+ * That worker can not join itself, so it is kept alive until it
+ * returned from its loop and gets detached when its thread exits.
+ */
+inline void stop_workers( std::vector< std::shared_ptr< WorkerThread > > & threads )
+{
+    for( auto & thread : threads )
+        thread->stop();
+
+    for( auto & thread : threads )
+        if( thread.get() == current_worker )
+            current_worker_keepalive = std::move( thread );
+
+    threads.clear();
+}
+
+inline void SleeperRegistry::push( WorkerThread & worker )
+{
+    {
+        std::lock_guard< std::mutex > lock( m );
+        if( ! worker.registered )
+        {
+            worker.registered = true;
+            sleeping.push_back( &worker );
+            n_sleeping.fetch_add( 1, std::memory_order_seq_cst );
+        }
+    }
+
+    // pairs with the fence in wake_one():
+    // either the waker sees this registration or we see its work
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+}
+
+inline void SleeperRegistry::remove( WorkerThread & worker )
+{
+    std::lock_guard< std::mutex > lock( m );
+    if( worker.registered )
+    {
+        worker.registered = false;
+        sleeping.erase( std::find( std::begin(sleeping), std::end(sleeping), &worker ) );
+        n_sleeping.fetch_sub( 1, std::memory_order_seq_cst );
+    }
+}
+
+inline bool SleeperRegistry::wake_one()
+{
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if( n_sleeping.load( std::memory_order_relaxed ) == 0 )
+        return false;
+
+    WorkerThread * worker = nullptr;
+    {
+        std::lock_guard< std::mutex > lock( m );
+        if( ! sleeping.empty() )
+        {
+            worker = sleeping.back();
+            sleeping.pop_back();
+            worker->registered = false;
+            n_sleeping.fetch_sub( 1, std::memory_order_seq_cst );
+        }
+    }
+
+    if( worker )
+    {
+        SPDLOG_TRACE("SleeperRegistry: wake worker {}", worker->id);
+        worker->notify();
+        return true;
+    }
+    else
+        return false;
+}
+
+inline bool SleeperRegistry::wake( unsigned worker_id )
+{
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if( n_sleeping.load( std::memory_order_relaxed ) == 0 )
+        return false;
+
+    WorkerThread * worker = nullptr;
+    {
+        std::lock_guard< std::mutex > lock( m );
+        auto it = std::find_if(
+            std::begin(sleeping), std::end(sleeping),
+            [worker_id]( WorkerThread * w ){ return w->id == worker_id; } );
+        if( it != std::end(sleeping) )
+        {
+            worker = *it;
+            sleeping.erase( it );
+            worker->registered = false;
+            n_sleeping.fetch_sub( 1, std::memory_order_seq_cst );
+        }
+    }
+
+    if( worker )
+    {
+        SPDLOG_TRACE("SleeperRegistry: wake worker {}", worker->id);
+        worker->notify();
+        return true;
+    }
+    else
+        return false;
+}
+
+inline void SleeperRegistry::wake_all()
+{
+    while( wake_one() )
+        ;
+}
+
 } // namespace thread
 } // namespace dispatch
 } // namespace redGrapes
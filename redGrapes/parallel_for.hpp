@@ -0,0 +1,142 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+ * @file redGrapes/parallel_for.hpp
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <tuple>
+
+#include <redGrapes/redGrapes.hpp>
+#include <redGrapes/resource/fieldresource.hpp>
+
+namespace redGrapes
+{
+
+/*! number of rows per tile if parallel_for() is not given a grain size:
+ *  a few tiles per worker for load balance, but not less than
+ *  a few thousand items per tile so that scheduling does not dominate
+ *
+ * @param n_rows rows of the area along the split dimension
+ * @param row_items items in one row
+ */
+inline size_t default_grain( size_t n_rows, size_t row_items )
+{
+    constexpr size_t tiles_per_worker = 4;
+    constexpr size_t min_tile_items = 4096;
+
+    size_t n_workers = top_scheduler ? top_scheduler->n_workers() : 0;
+    if( n_workers == 0 )
+        n_workers = dispatch::thread::default_n_workers();
+
+    size_t n_tiles = tiles_per_worker * n_workers;
+    size_t grain = ( n_rows + n_tiles - 1 ) / n_tiles;
+    size_t min_grain = ( min_tile_items + row_items - 1 ) / std::max( row_items, size_t(1) );
+
+    return std::max( { grain, min_grain, size_t(1) } );
+}
+
+namespace detail
+{
+
+//! call f for every index in [begin, end), the first dimension runs fastest
+template < typename Index, typename F >
+inline void for_each_index( Index const & begin, Index const & end, F && f )
+{
+    for( size_t d = 0; d < begin.size(); ++d )
+        if( begin[d] >= end[d] )
+            return;
+
+    Index index = begin;
+    while( true )
+    {
+        f( index );
+
+        size_t d = 0;
+        for( ; d < index.size(); ++d )
+        {
+            if( ++index[d] < end[d] )
+                break;
+            index[d] = begin[d];
+        }
+
+        if( d == index.size() )
+            return;
+    }
+}
+
+} // namespace detail
+
+/*! call `body( index, item, args... )` for each item in the area of `guard`,
+ *  in parallel.
+ *
+ * The area is split along its last (slowest) dimension into tiles of
+ * `grain` rows. Each tile becomes one task which accesses the tile
+ * through guard.area() and the additional arguments `args` as a whole,
+ * all tiles are emplaced at once with emplace_task_range().
+ *
+ * @param guard read or write access to a FieldResource or an area of it
+ * @param body called with the index, a reference to the item
+ *             and `args`, once per item
+ * @param grain rows per tile, 0 to choose with default_grain()
+ * @param args further arguments of the tasks, e.g. a read access to
+ *             another field. Arguments which conflict between the tiles
+ *             order the tiles by their position.
+ *
+ * Example:
+ * \code
+ * redGrapes::parallel_for(
+ *     dst.write(),
+ *     []( auto index, int & x, auto src ) { x = src[{ index[0] - 1 }] + src[{ index[0] + 1 }]; },
+ *     0,
+ *     src.read() );
+ * \endcode
+ */
+template < typename Guard, typename Body, typename... Args >
+void parallel_for( Guard const & guard, Body body, size_t grain = 0, Args&&... args )
+{
+    using Index = typename Guard::Index;
+    constexpr size_t split = Guard::dim - 1;
+
+    Index begin = guard.area_begin();
+    Index end = guard.area_end();
+    for( size_t d = 0; d < Guard::dim; ++d )
+        if( begin[d] >= end[d] )
+            return;
+
+    size_t n_rows = end[ split ] - begin[ split ];
+    size_t row_items = 1;
+    for( size_t d = 0; d < split; ++d )
+        row_items *= end[d] - begin[d];
+
+    if( grain == 0 )
+        grain = default_grain( n_rows, row_items );
+
+    emplace_task_range(
+        size_t(0), ( n_rows + grain - 1 ) / grain,
+        [body]( size_t, auto tile, auto&... args )
+        {
+            detail::for_each_index(
+                tile.area_begin(),
+                tile.area_end(),
+                [&]( Index const & index ) { body( index, tile[ index ], args... ); });
+        },
+        [&]( size_t t )
+        {
+            Index tile_begin = begin;
+            Index tile_end = end;
+            tile_begin[ split ] = begin[ split ] + t * grain;
+            tile_end[ split ] = std::min( end[ split ], tile_begin[ split ] + grain );
+
+            return std::make_tuple( guard.area( tile_begin, tile_end ), args... );
+        });
+}
+
+} // namespace redGrapes
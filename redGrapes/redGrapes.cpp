@@ -7,10 +7,12 @@
 
 #include <optional>
 #include <functional>
+#include <thread>
 #include <moodycamel/concurrentqueue.h>
 
 #include <redGrapes/redGrapes.hpp>
 #include <redGrapes/scheduler/default_scheduler.hpp>
+#include <redGrapes/scheduler/work_stealing_scheduler.hpp>
 
 namespace redGrapes
 {
@@ -29,9 +31,7 @@ std::shared_ptr<TaskSpace> current_task_space()
     {
         if( ! current_task->children )
         {
-            auto task_space = std::make_shared<TaskSpace>(*current_task);
-            active_task_spaces.enqueue(task_space);
-            current_task->children = task_space;
+            current_task->children = std::make_shared<TaskSpace>(*current_task);
         }
 
         return current_task->children;
@@ -80,13 +80,20 @@ std::vector<std::reference_wrapper<Task>> backtrace()
 void init( std::shared_ptr<scheduler::IScheduler> scheduler )
 {
     top_space = std::make_shared<TaskSpace>();
-    active_task_spaces.enqueue(top_space);
     top_scheduler = scheduler;
 }
 
 void init( size_t n_threads )
 {
-    init(std::make_shared<scheduler::DefaultScheduler>(n_threads));
+    init(std::make_shared<scheduler::WorkStealingScheduler>(n_threads));
+}
+
+void init(
+    size_t n_threads,
+    dispatch::thread::IdlePolicy idle_policy,
+    dispatch::thread::PinningPolicy pinning )
+{
+    init(std::make_shared<scheduler::WorkStealingScheduler>(n_threads, idle_policy, pinning));
 }
 
 /*! wait until all tasks in the current task space finished
@@ -100,25 +107,47 @@ void barrier()
 void finalize()
 {
     barrier();
+
+    // a worker which removed the last task might still be notifying,
+    // so wait until all workers returned before tearing down
+    top_scheduler->stop();
+
     top_scheduler.reset();
     top_space.reset();
+
+    trace::dump();
+    profiler::dump();
 }
 
-//! pause the currently running task at least until event is reached
+/*! pause the currently running task at least until event is reached.
+ *  A task without may_yield can not be paused, its thread executes
+ *  other tasks in the meantime.
+ */
 void yield( scheduler::EventPtr event )
 {
+    if( current_task && current_task->is_stackless() && ! event->is_reached() )
+        trace::ThreadCounters::add( trace::counters().stackless_waits );
+
     while(! event->is_reached() )
     {
-        if( current_task )
+        if( current_task && ! current_task->is_stackless() )
             current_task->yield(event);
+        else if( dispatch::thread::current_worker )
+            dispatch::thread::current_worker->wait_for( event );
         else
             idle();
     }
 }
 
+/*! initialize tasks of the spaces which have uninitialized tasks.
+ *  Spaces are only enqueued when a task gets emplaced into them,
+ *  so idle spaces cost nothing here.
+ */
 void update_active_task_spaces()
 {
     SPDLOG_TRACE("update active task spaces");
+    uint64_t begin = trace::now_ns();
+
     std::vector< std::shared_ptr< TaskSpace > > buf;
 
     std::shared_ptr< TaskSpace > space;
@@ -129,29 +158,43 @@ void update_active_task_spaces()
         if( space->init_until_ready() )
             notify = true;
 
-        bool remove_space = false;
-        if( auto parent = space->parent )
-        {
-            if(
-                space->empty() &&
-                parent->is_dead()
-            )
-            {
-                parent->space->try_remove( *parent );
-                remove_space = true;
-                notify = true;
-            }
-        }
-
-        if(! remove_space)
+        // initialization stops at the first ready task,
+        // the rest is left for the next update
+        if( space->reschedule() )
             buf.push_back(space);
     }
 
     for( auto space : buf )
         active_task_spaces.enqueue(space);
 
+    // a task emplaced while we initialized its space did not wake
+    // anybody, and we might be about to park ourselves
+    if( ! buf.empty() )
+        top_scheduler->wake_worker();
+
     if( notify )
         top_scheduler->notify();
+
+    trace::ThreadCounters & counters = trace::counters();
+    trace::ThreadCounters::add( counters.update_calls );
+    trace::ThreadCounters::add( counters.update_ns, trace::now_ns() - begin );
+}
+
+Stats stats()
+{
+    Stats s;
+    trace::collect_thread_stats( s.threads, s.total );
+
+    s.live_tasks = int64_t( s.total.tasks_created ) - int64_t( s.total.tasks_removed );
+    s.allocator_chunks = memory::chunks_in_use();
+
+    if( top_scheduler )
+        s.ready_queue_depth = top_scheduler->queue_depth();
+
+    if( top_space )
+        s.top_space_tasks = top_space->task_count;
+
+    return s;
 }
 
 //! apply a patch to the properties of the currently running task
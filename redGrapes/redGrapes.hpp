@@ -9,14 +9,25 @@
 
 #include <redGrapes/context.hpp>
 #include <redGrapes/dispatch/dispatcher.hpp>
+#include <redGrapes/dispatch/thread/idle_policy.hpp>
+#include <redGrapes/dispatch/thread/topology.hpp>
 #include <redGrapes/scheduler/scheduler.hpp>
 #include <redGrapes/scheduler/event.hpp>
+#include <redGrapes/scheduler/rank.hpp>
 #include <redGrapes/task/future.hpp>
 #include <redGrapes/task/task.hpp>
+#include <redGrapes/task/task_graph.hpp>
 
 #include <redGrapes/task/task_space.hpp>
+#include <redGrapes/trace/counters.hpp>
+#include <redGrapes/trace/profiler.hpp>
+#include <redGrapes/trace/tracer.hpp>
 #include <spdlog/spdlog.h>
+#include <functional>
+#include <tuple>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace redGrapes
 {
@@ -50,8 +61,22 @@ namespace redGrapes
 
     /* USER INTERFACE */
     void init(std::shared_ptr<scheduler::IScheduler> scheduler);
-    void init(size_t n_threads = std::thread::hardware_concurrency());
+    //! initialize with one worker per CPU in the affinity mask of the process
+    void init(size_t n_threads = dispatch::thread::default_n_workers());
 
+    /*! initialize with the default scheduler
+     * @param idle_policy what worker threads do when they run out of jobs
+     * @param pinning how worker threads are pinned to CPUs
+     */
+    void init(
+        size_t n_threads,
+        dispatch::thread::IdlePolicy idle_policy,
+        dispatch::thread::PinningPolicy pinning = dispatch::thread::PinningPolicy::COMPACT);
+
+    /*! wait for all tasks, stop the scheduler,
+     *  write the trace if trace::enable() was called and
+     *  report the critical path if profiler::enable() was called
+     */
     void finalize();
 
     //! wait until all tasks in the current task space finished
@@ -66,6 +91,11 @@ namespace redGrapes
     //! get backtrace from currently running task
     std::vector<std::reference_wrapper<Task>> backtrace();
 
+    /*! snapshot of the runtime counters,
+     *  may be called from any thread between init() and finalize()
+     */
+    Stats stats();
+
 
     /*! Create an event on which the termination of the current task depends.
      *  A task must currently be running.
@@ -127,11 +157,86 @@ namespace redGrapes
         };
 */
         builder.init_id();
+        trace::record_create( builder.prop );
+        profiler::record_create( builder.prop, current_task );
+        scheduler::rank::record_create( builder.prop, typeid( Callable ) );
+
+        std::shared_ptr<TaskSpace> space = current_task_space();
+        if( TaskGraph * graph = TaskGraph::recording() )
+            graph->capture( impl, builder.prop, typeid( Callable ), space );
 
         SPDLOG_DEBUG("redGrapes::emplace_task {}", (TaskProperties const&)builder);
-        Task& task = current_task_space()->emplace_task(std::move(impl), (TaskProperties &&) builder);
+        Task& task = space->emplace_task(std::move(impl), (TaskProperties &&) builder);
 
         return Future<typename std::result_of<Callable(Args...)>::type>(task);
     }
 
+    namespace detail
+    {
+        template<typename Tuple, size_t... Is>
+        inline void build_properties(PropBuildHelper& build_helper, Tuple const& args, std::index_sequence<Is...>)
+        {
+            pass(build_helper.template build<typename std::tuple_element<Is, Tuple>::type>(std::get<Is>(args))...);
+        }
+
+        template<typename Callable, typename Index, typename Tuple, size_t... Is>
+        inline auto bind_args(Callable& f, Index i, Tuple& args, std::index_sequence<Is...>)
+        {
+            return std::bind(f, i, std::get<Is>(std::move(args))...);
+        }
+    } // namespace detail
+
+    /*! create one task for each index in [begin, end) at once,
+     *  as child of the currently running task (if there is one).
+     *
+     * Compared to calling emplace_task() in a loop, the tasks are allocated
+     * together, go through the emplacement queue as one element, the workers
+     * are notified once and the task lists of their resources are locked
+     * once when they are inserted into the dependency graph.
+     * This pays off for tasks which are independent of each other,
+     * e.g. access disjoint tiles of a field. Tasks of the range which do
+     * conflict are ordered by their index, as with emplace_task().
+     * Their results are discarded.
+     *
+     * @param f callable that takes the index and the arguments of its task
+     * @param access returns the arguments of the task for an index as std::tuple,
+     *               e.g. std::make_tuple( field.at({ i }).write() ).
+     *               Their properties are added to the task as with emplace_task().
+     */
+    template<typename Index, typename Callable, typename AccessGenerator>
+    void emplace_task_range(Index begin, Index end, Callable&& f, AccessGenerator&& access)
+    {
+        using Args = decltype(access(begin));
+        using Indices = std::make_index_sequence<std::tuple_size<Args>::value>;
+        using Impl = decltype(detail::bind_args(f, begin, std::declval<Args&>(), Indices()));
+
+        std::shared_ptr<TaskSpace> space = current_task_space();
+        TaskGraph* graph = TaskGraph::recording();
+
+        std::vector<Task*> tasks = space->template emplace_task_range<Impl>(
+            (begin < end) ? size_t(end - begin) : 0,
+            [&](size_t k, typename TaskProperties::Builder& builder)
+            {
+                Index i = begin + Index(k);
+                Args args = access(i);
+
+                PropBuildHelper build_helper{builder};
+                detail::build_properties(build_helper, args, Indices());
+                Impl impl = detail::bind_args(f, i, args, Indices());
+
+                builder.init_id();
+                trace::record_create( builder.prop );
+                profiler::record_create( builder.prop, current_task );
+                scheduler::rank::record_create( builder.prop, typeid( Callable ) );
+
+                if( graph )
+                    graph->capture( impl, builder.prop, typeid( Callable ), space );
+
+                return impl;
+            });
+
+        for(Task* task : tasks)
+            task->get_result_get_event().notify();
+    }
+
 } // namespace redGrapes
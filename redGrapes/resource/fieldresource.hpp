@@ -11,6 +11,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <limits>
 
 #include <redGrapes/resource/access/field.hpp>
@@ -50,6 +52,11 @@ struct Field< std::array<T, N> >
     using Item = T;
     static constexpr size_t dim = 1;
 
+    static std::array<size_t, dim> extent( std::array<T, N> & )
+    {
+        return { N };
+    }
+
     static Item & get( std::array<T, N> & array, std::array<size_t, dim> index )
     {
         return array[ index[0] ];
@@ -62,6 +69,11 @@ struct Field< std::array<std::array<T, Nx>, Ny> >
     using Item = T;
     static constexpr size_t dim = 2;
 
+    static std::array<size_t, dim> extent( std::array<std::array<T, Nx>, Ny> & )
+    {
+        return { Nx, Ny };
+    }
+
     static Item & get( std::array<std::array<T, Nx>, Ny> & array, std::array<size_t, dim> index )
     {
         return array[ index[1] ][ index[0] ];
@@ -91,6 +103,24 @@ struct AreaGuard : SharedResourceObject< Container, access::FieldAccess< trait::
         return true;
     }
 
+    //! first index of the area
+    Index area_begin() const noexcept
+    {
+        Index begin;
+        for( size_t d = 0; d < dim; d++ )
+            begin[d] = m_area[d][0];
+        return begin;
+    }
+
+    //! end of the area, clipped to the extent of the field
+    Index area_end() const
+    {
+        Index end = trait::Field< Container >::extent( *this->obj );
+        for( size_t d = 0; d < dim; d++ )
+            end[d] = std::min( end[d], m_area[d][1] );
+        return end;
+    }
+
 protected:
     AreaGuard( std::shared_ptr<Container> obj )
         : SharedResourceObject< Container, access::FieldAccess<dim> >( obj )
@@ -0,0 +1,339 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+ * @file redGrapes/resource/reductionresource.hpp
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include <redGrapes/task/allocator.hpp>
+#include <redGrapes/task/property/resource.hpp>
+#include <redGrapes/task/property/trait.hpp>
+#include <redGrapes/resource/access/io.hpp>
+#include <redGrapes/resource/resource.hpp>
+
+namespace redGrapes
+{
+namespace reductionresource
+{
+
+/*!
+ * Value of a ReductionResource together with the partial results
+ * of the tasks which currently reduce into it.
+ *
+ * Each thread which runs a reducing task gets a partial of its own,
+ * so the concurrent tasks do not need to synchronize. The partials
+ * are merged into the value by the first task that reads or writes it
+ * afterwards, at that point all reducing tasks before it are finished.
+ * Partials of threads which did not reduce since the previous merge
+ * are dropped then, so exited workers do not accumulate.
+ */
+template < typename T, typename Op >
+struct State
+{
+    //! aligned, so that partials of different threads do not share a cache line
+    struct alignas(64) Partial
+    {
+        //! see memory::current_thread_index()
+        unsigned const thread;
+        Partial * next;
+
+        T value;
+        bool used;
+
+        Partial( unsigned thread, Partial * next, T const & identity )
+            : thread( thread ), next( next ), value( identity ), used( false )
+        {}
+
+        // operator new ignores extended alignment before C++17
+        static Partial * create( unsigned thread, Partial * next, T const & identity )
+        {
+            void * mem = ::aligned_alloc( alignof( Partial ), sizeof( Partial ) );
+            if( ! mem )
+                throw std::bad_alloc();
+
+            try
+            {
+                return new ( mem ) Partial( thread, next, identity );
+            }
+            catch( ... )
+            {
+                ::free( mem );
+                throw;
+            }
+        }
+
+        static void destroy( Partial * p )
+        {
+            p->~Partial();
+            ::free( p );
+        }
+    };
+
+    T value;
+    T const identity;
+    Op op;
+
+    //! partials of the threads which reduced into this value since the last merge
+    std::atomic< Partial * > partials;
+
+    /*! true if some partial is used. Set by the reducing tasks,
+     *  which are ordered before the next merge by their dependencies.
+     */
+    std::atomic< bool > pending;
+
+    //! serializes merges by concurrent readers
+    std::mutex merge_mutex;
+
+    /*! incremented by every merge which dropped a partial,
+     *  a partial cached by a ReduceGuard is only valid within one generation
+     */
+    std::atomic< uint64_t > generation;
+
+    State( T value, T identity, Op op )
+        : value( std::move( value ) )
+        , identity( std::move( identity ) )
+        , op( std::move( op ) )
+        , partials( nullptr )
+        , pending( false )
+        , generation( 0 )
+    {}
+
+    State( State const & ) = delete;
+
+    ~State()
+    {
+        Partial * p = partials.load();
+        while( p )
+        {
+            Partial * next = p->next;
+            Partial::destroy( p );
+            p = next;
+        }
+    }
+
+    /*! partial of the given thread, created on first use
+     *  @param thread memory::current_thread_index() of the caller
+     */
+    Partial & partial_of( unsigned thread )
+    {
+        Partial * head = partials.load( std::memory_order_acquire );
+        for( Partial * p = head; p; p = p->next )
+            if( p->thread == thread )
+                return *p;
+
+        // only this thread adds a partial for itself,
+        // so it can not be added concurrently
+        Partial * p = Partial::create( thread, head, identity );
+        while( ! partials.compare_exchange_weak( p->next, p, std::memory_order_release, std::memory_order_acquire ) )
+            ;
+
+        return *p;
+    }
+
+    //! mark a partial as used by the current reduction
+    T & use( Partial & p )
+    {
+        if( ! p.used )
+        {
+            p.used = true;
+            pending.store( true, std::memory_order_relaxed );
+        }
+        return p.value;
+    }
+
+    /*! combine the used partials pairwise, then into the value,
+     *  reset them to the identity and drop the unused ones
+     */
+    void merge()
+    {
+        // a concurrent reader may have merged already
+        if( ! pending.load( std::memory_order_acquire ) )
+            return;
+
+        std::lock_guard< std::mutex > lock( merge_mutex );
+        if( ! pending.load( std::memory_order_relaxed ) )
+            return;
+
+        // no reducing task runs concurrently, so the list may be changed
+        std::vector< Partial * > used;
+        bool dropped = false;
+        for( Partial * p = partials.load( std::memory_order_acquire ); p; )
+        {
+            Partial * next = p->next;
+            if( p->used )
+                used.push_back( p );
+            else
+            {
+                Partial::destroy( p );
+                dropped = true;
+            }
+            p = next;
+        }
+
+        if( dropped )
+            generation.fetch_add( 1, std::memory_order_release );
+
+        for( size_t i = 0; i < used.size(); ++i )
+            used[ i ]->next = ( i + 1 < used.size() ) ? used[ i + 1 ] : nullptr;
+        partials.store( used.empty() ? nullptr : used[ 0 ], std::memory_order_release );
+
+        for( size_t stride = 1; stride < used.size(); stride *= 2 )
+            for( size_t i = 0; i + stride < used.size(); i += 2 * stride )
+                used[ i ]->value = op( std::move( used[ i ]->value ), used[ i + stride ]->value );
+
+        if( ! used.empty() )
+            value = op( std::move( value ), used[ 0 ]->value );
+
+        for( Partial * p : used )
+        {
+            p->value = identity;
+            p->used = false;
+        }
+
+        pending.store( false, std::memory_order_release );
+    }
+};
+
+template < typename T, typename Op >
+struct ReadGuard : public SharedResourceObject< State< T, Op >, access::IOAccess >
+{
+    operator ResourceAccess() const noexcept { return this->make_access(access::IOAccess::read); }
+
+    ReadGuard read() const noexcept { return *this; }
+
+    T const & operator* () const { this->obj->merge(); return this->obj->value; }
+    T const * operator-> () const { return &**this; }
+
+protected:
+    ReadGuard( std::shared_ptr< State< T, Op > > obj ) : SharedResourceObject< State< T, Op >, access::IOAccess >( obj ) {}
+};
+
+template < typename T, typename Op >
+struct WriteGuard : public ReadGuard< T, Op >
+{
+    operator ResourceAccess() const noexcept { return this->make_access(access::IOAccess::write); }
+
+    WriteGuard write() const noexcept { return *this; }
+
+    T & operator* () const { this->obj->merge(); return this->obj->value; }
+    T * operator-> () const { return &**this; }
+
+protected:
+    WriteGuard( std::shared_ptr< State< T, Op > > obj ) : ReadGuard< T, Op >( obj ) {}
+};
+
+/*!
+ * Access of a task which reduces into the value,
+ * tasks with this access run concurrently (IOAccess::aadd).
+ */
+template < typename T, typename Op >
+struct ReduceGuard : public SharedResourceObject< State< T, Op >, access::IOAccess >
+{
+    operator ResourceAccess() const noexcept { return this->make_access(access::IOAccess::aadd); }
+
+    /*! partial result of the calling thread, starts as the identity.
+     *
+     * Only valid during the task and on the current thread: a task with
+     * `may_yield` may continue on another worker after it waited, while
+     * other tasks keep reducing into the partial of this thread.
+     * Such a task must not hold the reference across a wait,
+     * but call local() again afterwards.
+     */
+    T & local() const
+    {
+        // the partial is looked up once per task and thread,
+        // and again after a merge which may have dropped it
+        unsigned thread = memory::current_thread_index();
+        uint64_t generation = this->obj->generation.load( std::memory_order_acquire );
+        if( ! partial || partial_generation != generation || partial->thread != thread )
+        {
+            partial = &this->obj->partial_of( thread );
+            partial_generation = generation;
+        }
+
+        return this->obj->use( *partial );
+    }
+
+    //! partial = op( partial, x )
+    template < typename U >
+    void combine( U && x ) const
+    {
+        T & p = local();
+        p = this->obj->op( std::move( p ), std::forward< U >( x ) );
+    }
+
+    ReduceGuard( WriteGuard< T, Op > const & w )
+        : SharedResourceObject< State< T, Op >, access::IOAccess >( w )
+        , partial( nullptr )
+        , partial_generation( 0 )
+    {}
+
+    //! a copy, e.g. of a replayed task, looks up its partial again
+    ReduceGuard( ReduceGuard const & other )
+        : SharedResourceObject< State< T, Op >, access::IOAccess >( other )
+        , partial( nullptr )
+        , partial_generation( 0 )
+    {}
+
+private:
+    //! partial of the last call to local(), only valid in partial_generation
+    mutable typename State< T, Op >::Partial * partial;
+    mutable uint64_t partial_generation;
+};
+
+} // namespace reductionresource
+
+/*!
+ * Value which many concurrent tasks reduce into with `reduce()`,
+ * e.g. a sum or a histogram.
+ *
+ * Instead of synchronizing on the shared value, each thread reduces
+ * into a private partial. Before a task which reads or writes the value
+ * accesses it, the partials are combined pairwise and then into the value.
+ *
+ * @tparam Op associative and commutative binary operation
+ *
+ * Example:
+ * \code
+ * redGrapes::ReductionResource< double > energy;
+ * for( auto & particle : particles )
+ *     redGrapes::emplace_task( []( auto e ) { e.combine( 0.5 ); }, energy.reduce() );
+ * redGrapes::emplace_task( []( auto e ) { std::cout << *e; }, energy.read() );
+ * \endcode
+ */
+template < typename T, typename Op = std::plus< T > >
+struct ReductionResource : public reductionresource::WriteGuard< T, Op >
+{
+    /*! @param value initial value
+     *  @param identity initial value of the partials, e.g. a histogram of zeros
+     */
+    ReductionResource( T value = T(), T identity = T(), Op op = Op() )
+        : reductionresource::WriteGuard< T, Op >(
+              std::make_shared< reductionresource::State< T, Op > >( std::move( value ), std::move( identity ), std::move( op ) )
+          )
+    {}
+
+    reductionresource::ReduceGuard< T, Op > reduce() const noexcept
+    {
+        return reductionresource::ReduceGuard< T, Op >( *this );
+    }
+
+}; // struct ReductionResource
+
+} // namespace redGrapes
@@ -21,11 +21,7 @@ int ResourceBase::getID()
 ResourceBase::ResourceBase()
     : id( getID() )
     , scope_level( scope_depth() )
-    , tasks(std::make_shared<
-            std::pair<
-                std::mutex,
-                std::vector<Task*>
-            >>())
+    , users( std::make_shared< ResourceUsers >() )
 {}
 
 bool ResourceBase::operator==( ResourceBase const & other ) const
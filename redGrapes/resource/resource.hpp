@@ -11,8 +11,13 @@
 
 #pragma once
 
-#include <boost/type_index.hpp>
-#include <memory> // std::unique_ptr<>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
 #include <vector>
 #include <mutex>
 #include <iostream>
@@ -31,6 +36,25 @@ class Resource;
 
 struct Task;
 
+/*!
+ * Live tasks which use a resource, in the order of their emplacement.
+ * Tasks which got removed (or are dominated by a newer task, see
+ * GraphProperty::init_graph) leave a hole behind. Holes are
+ * compacted once they make up most of the list.
+ */
+struct ResourceUsers
+{
+    std::mutex mutex;
+    std::vector< Task* > tasks;
+    unsigned n_holes = 0;
+
+    //! number of tasks ever inserted into `tasks`
+    uint64_t n_inserted = 0;
+
+    //! id of the worker which executed the last writing task, -1 if none
+    std::atomic< int > last_writer{ -1 };
+};
+
 class ResourceBase
 {
 protected:
@@ -40,7 +64,7 @@ public:
     unsigned int id;
     unsigned int scope_level;
 
-    std::shared_ptr< std::pair<std::mutex, std::vector<Task*>> > tasks;
+    std::shared_ptr< ResourceUsers > users;
 
     /**
      * Create a new resource with an unused ID.
@@ -53,90 +77,221 @@ public:
 template <typename AccessPolicy>
 class Resource;
 
+/**
+ * Type-erased access to some resource.
+ *
+ * The access policy is stored inline if it is small enough
+ * (e.g. IOAccess, AreaAccess, FieldAccess<3>), so that copies do not
+ * allocate. All operations on the policy go through a static function
+ * table, one per policy type, whose address also identifies the type.
+ */
 class ResourceAccess
 {
     template <typename AccessPolicy>
     friend class Resource;
 
   private:
-    struct AccessBase
+    struct PolicyTable
     {
-        AccessBase( boost::typeindex::type_index access_type_, ResourceBase resource )
-            : access_type( access_type_ )
-            , resource( resource )
+        unsigned policy_id;
+
+        bool ( *is_serial )( void const * a, void const * b );
+        bool ( *is_superset_of )( void const * a, void const * b );
+        bool ( *equal )( void const * a, void const * b );
+
+        void ( *copy )( void * dst, void const * src );
+        void ( *move )( void * dst, void * src );
+        void ( *destroy )( void * );
+
+        std::string ( *mode_format )( void const * );
+    };
+
+    //! policies up to this size are stored inline
+    static constexpr size_t inline_size = 56;
+    using Storage = typename std::aligned_storage< inline_size, alignof(std::max_align_t) >::type;
+
+    static unsigned new_policy_id()
+    {
+        static std::atomic< unsigned > next_id( 0 );
+        return next_id++;
+    }
+
+    template < typename AccessPolicy >
+    struct Policy
+    {
+        static constexpr bool is_inline =
+            sizeof( AccessPolicy ) <= inline_size &&
+            alignof( AccessPolicy ) <= alignof( std::max_align_t );
+
+        static AccessPolicy const & get( void const * storage )
         {
+            if( is_inline )
+                return *static_cast< AccessPolicy const * >( storage );
+            else
+                return **static_cast< AccessPolicy * const * >( storage );
         }
 
-        virtual ~AccessBase() {};
-        virtual bool operator==( AccessBase const & r ) const = 0;
-
-        bool
-        is_same_resource( ResourceAccess::AccessBase const & a ) const
+        static void construct( void * storage, AccessPolicy const & policy )
         {
-            return this->resource.id == a.resource.id;
+            if( is_inline )
+                new ( storage ) AccessPolicy( policy );
+            else
+                *static_cast< AccessPolicy ** >( storage ) = new AccessPolicy( policy );
         }
 
-        virtual bool is_serial( AccessBase const & r ) const = 0;
-        virtual bool is_superset_of( AccessBase const & r ) const = 0;
-        virtual AccessBase * clone( void ) const = 0;
-        virtual std::string mode_format() const = 0;
+        static PolicyTable const * table()
+        {
+            static PolicyTable const t = {
+                new_policy_id(),
+                []( void const * a, void const * b )
+                {
+                    return AccessPolicy::is_serial( get( a ), get( b ) );
+                },
+                []( void const * a, void const * b )
+                {
+                    return get( a ).is_superset_of( get( b ) );
+                },
+                []( void const * a, void const * b )
+                {
+                    return bool( get( a ) == get( b ) );
+                },
+                []( void * dst, void const * src )
+                {
+                    construct( dst, get( src ) );
+                },
+                []( void * dst, void * src )
+                {
+                    if( is_inline )
+                        new ( dst ) AccessPolicy( std::move( *static_cast< AccessPolicy * >( src ) ) );
+                    else
+                    {
+                        *static_cast< AccessPolicy ** >( dst ) = *static_cast< AccessPolicy ** >( src );
+                        *static_cast< AccessPolicy ** >( src ) = nullptr;
+                    }
+                },
+                []( void * storage )
+                {
+                    if( is_inline )
+                        static_cast< AccessPolicy * >( storage )->~AccessPolicy();
+                    else
+                        delete *static_cast< AccessPolicy ** >( storage );
+                },
+                []( void const * storage )
+                {
+                    return fmt::format( "{}", get( storage ) );
+                }
+            };
+
+            return &t;
+        }
+    };
 
-        boost::typeindex::type_index access_type;
-        ResourceBase resource;
-    }; // AccessBase
+    PolicyTable const * table;
+    ResourceBase resource;
+    Storage storage;
 
-    std::unique_ptr<AccessBase> obj;
+    template < typename AccessPolicy >
+    ResourceAccess( ResourceBase const & resource, AccessPolicy const & policy )
+        : table( Policy< AccessPolicy >::table() )
+        , resource( resource )
+    {
+        Policy< AccessPolicy >::construct( &storage, policy );
+    }
 
   public:
-    ResourceAccess( AccessBase * obj_ ) : obj( obj_ ) {}
-    ResourceAccess( ResourceAccess const & r ) : obj( r.obj->clone() ) {}
-    ResourceAccess( ResourceAccess && r ) : obj( std::move( r.obj ) ) {}
+    ResourceAccess( ResourceAccess const & r )
+        : table( r.table )
+        , resource( r.resource )
+    {
+        table->copy( &storage, &r.storage );
+    }
+
+    ResourceAccess( ResourceAccess && r )
+        : table( r.table )
+        , resource( std::move( r.resource ) )
+    {
+        table->move( &storage, &r.storage );
+    }
+
+    ~ResourceAccess()
+    {
+        table->destroy( &storage );
+    }
 
     ResourceAccess &
     operator=( ResourceAccess const & r )
     {
-        this->obj.reset( r.obj->clone() );
+        if( this != &r )
+        {
+            table->destroy( &storage );
+            table = r.table;
+            resource = r.resource;
+            table->copy( &storage, &r.storage );
+        }
+        return *this;
+    }
+
+    ResourceAccess &
+    operator=( ResourceAccess && r )
+    {
+        if( this != &r )
+        {
+            table->destroy( &storage );
+            table = r.table;
+            resource = std::move( r.resource );
+            table->move( &storage, &r.storage );
+        }
         return *this;
     }
 
     static bool
     is_serial( ResourceAccess const & a, ResourceAccess const & b )
     {
-        if ( a.obj->access_type == b.obj->access_type )
-            return a.obj->is_serial( *b.obj );
-        else
-            return false;
+        return a.table == b.table
+            && a.resource.id == b.resource.id
+            && a.table->is_serial( &a.storage, &b.storage );
     }
 
     bool
     is_superset_of( ResourceAccess const & a ) const
     {
-        //if ( this->obj->resource.scope_level < a.obj->resource.scope_level )
+        //if ( this->resource.scope_level < a.resource.scope_level )
         //    return true;
-        if ( this->obj->access_type == a.obj->access_type )
-            return this->obj->is_superset_of( *a.obj );
-        else
-            return false;
+        return this->table == a.table
+            && this->resource.id == a.resource.id
+            && this->table->is_superset_of( &this->storage, &a.storage );
+    }
+
+    //! distinct for each type of access policy
+    unsigned int policy_id() const
+    {
+        return this->table->policy_id;
     }
 
     unsigned int scope_level() const
     {
-        return this->obj->resource.scope_level;
+        return this->resource.scope_level;
     }
 
     unsigned int resource_id() const
     {
-        return this->obj->resource.id;
+        return this->resource.id;
     }
 
     std::string mode_format() const
     {
-        return this->obj->mode_format();
+        return this->table->mode_format( &this->storage );
     }
 
     ResourceBase get_resource()
     {
-        return obj->resource;
+        return resource;
+    }
+
+    //! state shared by all copies of the resource
+    ResourceUsers & get_users() const
+    {
+        return *resource.users;
     }
     
     /**
@@ -148,17 +303,15 @@ class ResourceAccess
     bool
     is_same_resource( ResourceAccess const & a ) const
     {
-        if ( this->obj->access_type == a.obj->access_type )
-            return this->obj->is_same_resource( *a.obj );
-        return false;
+        return this->table == a.table
+            && this->resource.id == a.resource.id;
     }
 
     bool
     operator== ( ResourceAccess const & a ) const
     {
-        if ( this->obj->access_type == a.obj->access_type )
-            return *(this->obj) == *(a.obj);
-        return false;
+        return this->is_same_resource( a )
+            && this->table->equal( &this->storage, &a.storage );
     }
 }; // class ResourceAccess
 
@@ -209,6 +362,8 @@ struct DefaultAccessPolicy
  * - `static bool is_superset(AccessPolicy a, AccessPolicy b)`
  * check if access `a` is a superset of access `b` (e.g. accessing [0,3] is a superset of accessing [1,2])
  *
+ * If `a` is a superset of `b`, every access which is serial to `b` must also be serial to `a`.
+ *
  * @}
  */
 
@@ -224,59 +379,6 @@ template <typename AccessPolicy = DefaultAccessPolicy>
 class Resource : public ResourceBase
 {
 protected:
-    struct Access : public ResourceAccess::AccessBase
-    {
-        Access( ResourceBase resource_, AccessPolicy policy_ )
-            : ResourceAccess::AccessBase(
-                  boost::typeindex::type_id<AccessPolicy>(),
-                  resource_
-              )
-            , policy( policy_ )
-        {}
-
-        ~Access() {}
-
-        bool
-        is_serial( ResourceAccess::AccessBase const & a_ ) const
-        {
-            Access const & a = *static_cast<Access const *>(
-                &a_ ); // no dynamic cast needed, type checked in ResourceAccess
-            return this->is_same_resource( a ) &&
-                   AccessPolicy::is_serial( this->policy, a.policy );
-        }
-
-        bool
-        is_superset_of( ResourceAccess::AccessBase const & a_ ) const
-        {
-            Access const & a = *static_cast<Access const *>(
-                &a_ ); // no dynamic cast needed, type checked in ResourceAccess
-            return this->is_same_resource( a ) &&
-                   this->policy.is_superset_of( a.policy );
-        }
-
-        bool
-        operator==( ResourceAccess::AccessBase const & a_ ) const
-        {
-            Access const & a = *static_cast<Access const *>(
-                &a_ ); // no dynamic cast needed, type checked in ResourceAccess
-
-            return ( this->is_same_resource(a_) && this->policy == a.policy );
-        }
-
-        AccessBase *
-        clone( void ) const
-        {
-            return new Access( this->resource, this->policy );
-        }
-
-        std::string mode_format() const
-        {
-            return fmt::format("{}", policy);
-        }
-
-        AccessPolicy policy;
-    }; // struct ThisResourceAccess
-
     friend class ResourceBase;
 
     Resource( ResourceBase const & base )
@@ -297,7 +399,7 @@ protected:
     ResourceAccess
     make_access( AccessPolicy pol ) const
     {
-        return ResourceAccess( new Access( *this, pol ) );
+        return ResourceAccess( *this, pol );
     }
 }; // class Resource
 
@@ -11,7 +11,10 @@
 
 #pragma once
 
+#include <algorithm>
 #include <list>
+#include <utility>
+#include <vector>
 #include <redGrapes/resource/resource.hpp>
 #include <redGrapes/context.hpp>
 
@@ -23,9 +26,16 @@ namespace redGrapes
 struct ResourceEntry
 {
     ResourceBase resource;
-    int task_idx; // index in task list of resource
+    int task_idx; // index in task list of resource, guarded by its mutex
 };
 
+/**
+ * Set of resource accesses of a task.
+ *
+ * Both `access_list` and `unique_resources` are kept sorted by resource id,
+ * so that conflicts between two users are found by a single merge pass
+ * and lookups of a resource are a binary search.
+ */
 class ResourceUser
 {
   public:    
@@ -42,49 +52,126 @@ class ResourceUser
 
     void add_resource_access( ResourceAccess ra )
     {
-        this->access_list.push_back(ra);
+        unsigned int id = ra.resource_id();
         ResourceBase r = ra.get_resource();
-        if( std::find_if(unique_resources.begin(), unique_resources.end(), [r](ResourceEntry const & e){ return e.resource == r; }) == unique_resources.end() )
-            unique_resources.push_back(ResourceEntry{ r, -1 });
+
+        auto it = std::upper_bound(
+            access_list.begin(), access_list.end(), id,
+            []( unsigned int id, ResourceAccess const & a ){ return id < a.resource_id(); } );
+        this->access_list.insert( it, std::move(ra) );
+
+        auto e = lower_bound_entry( id );
+        if( e == unique_resources.end() || e->resource.id != id )
+            unique_resources.insert( e, ResourceEntry{ r, -1 } );
     }
 
     void rm_resource_access( ResourceAccess ra )
     {
-        auto it = std::find(this->access_list.begin(), this->access_list.end(), ra);
+        auto range = access_list_range( ra.resource_id() );
+        auto it = std::find( range.first, range.second, ra );
         this->access_list.erase(it);
     }
 
     void build_unique_resource_list()
     {
+        std::stable_sort(
+            access_list.begin(), access_list.end(),
+            []( ResourceAccess const & a, ResourceAccess const & b ){ return a.resource_id() < b.resource_id(); } );
+
         unique_resources.clear();
         unique_resources.reserve(access_list.size());
+        for( auto & ra : access_list )
+            if( unique_resources.empty() || unique_resources.back().resource.id != ra.resource_id() )
+                unique_resources.push_back(ResourceEntry{ ra.get_resource(), -1 });
+    }
+
+    //! remember the worker which executed a write to the resources
+    void mark_written( int worker_id )
+    {
+        for( auto & ra : access_list )
+            if( ResourceAccess::is_serial( ra, ra ) )
+                ra.get_users().last_writer.store( worker_id, std::memory_order_relaxed );
+    }
+
+    /*! @return worker which last wrote a resource written by this user,
+     *          or else one used by it, -1 if unknown
+     */
+    int last_writer() const
+    {
+        int any = -1;
         for( auto & ra : access_list )
         {
-            ResourceBase r = ra.get_resource();
-            if( std::find_if(unique_resources.begin(), unique_resources.end(), [r](ResourceEntry const & e){ return e.resource == r; }) == unique_resources.end() )
-            unique_resources.push_back(ResourceEntry{ r, -1 });            
+            int w = ra.get_users().last_writer.load( std::memory_order_relaxed );
+            if( w >= 0 && ResourceAccess::is_serial( ra, ra ) )
+                return w;
+            if( any < 0 )
+                any = w;
         }
+        return any;
+    }
+
+    //! @return entry of the resource or nullptr if it is not used
+    ResourceEntry * get_resource_entry( unsigned int resource_id )
+    {
+        auto e = lower_bound_entry( resource_id );
+        if( e != unique_resources.end() && e->resource.id == resource_id )
+            return &*e;
+        return nullptr;
     }
 
     static bool
     is_serial( ResourceUser const & a, ResourceUser const & b )
     {
-        for ( ResourceAccess const & ra : a.access_list )
-            for ( ResourceAccess const & rb : b.access_list )
-                if ( ResourceAccess::is_serial( ra, rb ) )
-                    return true;
+        auto ia = a.access_list.begin();
+        auto ib = b.access_list.begin();
+
+        // merge join over the resource ids
+        while ( ia != a.access_list.end() && ib != b.access_list.end() )
+        {
+            unsigned int id = ia->resource_id();
+            if ( id < ib->resource_id() )
+                ++ia;
+            else if ( ib->resource_id() < id )
+                ++ib;
+            else
+            {
+                auto end_a = ia;
+                while ( end_a != a.access_list.end() && end_a->resource_id() == id )
+                    ++end_a;
+
+                auto end_b = ib;
+                while ( end_b != b.access_list.end() && end_b->resource_id() == id )
+                    ++end_b;
+
+                for ( auto ra = ia; ra != end_a; ++ra )
+                    for ( auto rb = ib; rb != end_b; ++rb )
+                        if ( ResourceAccess::is_serial( *ra, *rb ) )
+                            return true;
+
+                ia = end_a;
+                ib = end_b;
+            }
+        }
         return false;
     }
 
     bool
     is_superset_of( ResourceUser const & a ) const
     {
+        auto it = this->access_list.begin();
         for ( ResourceAccess const & ra : a.access_list )
         {
+            // both lists are sorted, so the candidates only move forward
+            while ( it != this->access_list.end() && it->resource_id() < ra.resource_id() )
+                ++it;
+
             bool found = false;
-            for ( ResourceAccess const & r : this->access_list )
-                if ( r.is_superset_of( ra ) )
+            for ( auto r = it; r != this->access_list.end() && r->resource_id() == ra.resource_id(); ++r )
+                if ( r->is_superset_of( ra ) )
+                {
                     found = true;
+                    break;
+                }
 
             if ( !found && ra.scope_level() <= scope_level )
                 // a introduced a new resource
@@ -99,10 +186,73 @@ class ResourceUser
         return a.is_superset_of(b);
     }
 
+    //! some access of a to the resource is serial to some access of b
+    static bool
+    is_serial( ResourceUser const & a, ResourceUser const & b, unsigned int resource_id )
+    {
+        auto range_a = a.access_list_range( resource_id );
+        auto range_b = b.access_list_range( resource_id );
+
+        for ( auto ra = range_a.first; ra != range_a.second; ++ra )
+            for ( auto rb = range_b.first; rb != range_b.second; ++rb )
+                if ( ResourceAccess::is_serial( *ra, *rb ) )
+                    return true;
+        return false;
+    }
+
+    //! every access of b to the resource is covered by an access of a
+    static bool
+    is_superset( ResourceUser const & a, ResourceUser const & b, unsigned int resource_id )
+    {
+        auto range_a = a.access_list_range( resource_id );
+        auto range_b = b.access_list_range( resource_id );
+
+        for ( auto rb = range_b.first; rb != range_b.second; ++rb )
+        {
+            bool found = false;
+            for ( auto ra = range_a.first; ra != range_a.second; ++ra )
+                if ( ra->is_superset_of( *rb ) )
+                {
+                    found = true;
+                    break;
+                }
+
+            if ( !found )
+                return false;
+        }
+        return true;
+    }
+
     unsigned int scope_level;
     std::vector<ResourceAccess> access_list;
 
     std::vector<ResourceEntry> unique_resources;
+
+  private:
+    using AccessIterator = std::vector<ResourceAccess>::const_iterator;
+
+    //! accesses to the resource, as range in access_list
+    std::pair< AccessIterator, AccessIterator >
+    access_list_range( unsigned int resource_id ) const
+    {
+        auto begin = std::lower_bound(
+            access_list.begin(), access_list.end(), resource_id,
+            []( ResourceAccess const & a, unsigned int id ){ return a.resource_id() < id; } );
+
+        auto end = begin;
+        while ( end != access_list.end() && end->resource_id() == resource_id )
+            ++end;
+
+        return std::make_pair( begin, end );
+    }
+
+    std::vector<ResourceEntry>::iterator
+    lower_bound_entry( unsigned int resource_id )
+    {
+        return std::lower_bound(
+            unique_resources.begin(), unique_resources.end(), resource_id,
+            []( ResourceEntry const & e, unsigned int id ){ return e.resource.id < id; } );
+    }
 }; // class ResourceUser
 
 } // namespace redGrapes
@@ -0,0 +1,189 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+ * @file redGrapes/scheduler/chase_lev_deque.hpp
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace redGrapes
+{
+namespace scheduler
+{
+
+/*!
+ * Dynamic circular work-stealing deque after Chase & Lev (2005),
+ * using the C11 memory orderings from Lê et al. (2013).
+ *
+ * The owning thread pushes and pops at the bottom (LIFO),
+ * any other thread may steal from the top (FIFO).
+ * Items must be trivially copyable (usually pointers).
+ */
+template < typename T >
+struct ChaseLevDeque
+{
+    ChaseLevDeque( size_t initial_capacity = 64 )
+        : top( 0 )
+        , bottom( 0 )
+    {
+        size_t capacity = 1;
+        while( capacity < initial_capacity )
+            capacity <<= 1;
+
+        buffers.emplace_back( std::make_unique< Buffer >( capacity ) );
+        buffer = buffers.back().get();
+    }
+
+    ChaseLevDeque( ChaseLevDeque const & ) = delete;
+
+    //! may only be called by the owning thread
+    void push( T item )
+    {
+        int64_t b = bottom.load( std::memory_order_relaxed );
+        int64_t t = top.load( std::memory_order_acquire );
+        Buffer * a = buffer.load( std::memory_order_relaxed );
+
+        if( b - t > (int64_t) a->capacity - 1 )
+            a = grow( a, b, t );
+
+        a->put( b, item );
+        std::atomic_thread_fence( std::memory_order_release );
+        bottom.store( b + 1, std::memory_order_relaxed );
+    }
+
+    /*! may only be called by the owning thread
+     * @return true if an item was taken
+     */
+    bool pop( T & item )
+    {
+        int64_t b = bottom.load( std::memory_order_relaxed ) - 1;
+        Buffer * a = buffer.load( std::memory_order_relaxed );
+        bottom.store( b, std::memory_order_relaxed );
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+        int64_t t = top.load( std::memory_order_relaxed );
+
+        if( t <= b )
+        {
+            item = a->get( b );
+            if( t == b )
+            {
+                // last item, race against thieves
+                bool won = top.compare_exchange_strong(
+                    t, t + 1,
+                    std::memory_order_seq_cst,
+                    std::memory_order_relaxed );
+
+                bottom.store( b + 1, std::memory_order_relaxed );
+                return won;
+            }
+            return true;
+        }
+        else
+        {
+            bottom.store( b + 1, std::memory_order_relaxed );
+            return false;
+        }
+    }
+
+    /*! may be called by any thread
+     * @return true if an item was taken,
+     *         false if the deque was empty or another thread won the race
+     */
+    bool steal( T & item )
+    {
+        int64_t t = top.load( std::memory_order_acquire );
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+        int64_t b = bottom.load( std::memory_order_acquire );
+
+        if( t < b )
+        {
+            Buffer * a = buffer.load( std::memory_order_acquire );
+            T x = a->get( t );
+            if( top.compare_exchange_strong(
+                    t, t + 1,
+                    std::memory_order_seq_cst,
+                    std::memory_order_relaxed ) )
+            {
+                item = x;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    //! approximate number of items, only exact if called by the owner
+    size_t size() const
+    {
+        int64_t b = bottom.load( std::memory_order_relaxed );
+        int64_t t = top.load( std::memory_order_relaxed );
+        return ( b > t ) ? ( b - t ) : 0;
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+private:
+    struct Buffer
+    {
+        size_t capacity;
+        std::unique_ptr< std::atomic< T >[] > items;
+
+        Buffer( size_t capacity )
+            : capacity( capacity )
+            , items( new std::atomic< T >[ capacity ] )
+        {}
+
+        T get( int64_t i ) const
+        {
+            return items[ i & ( capacity - 1 ) ].load( std::memory_order_relaxed );
+        }
+
+        void put( int64_t i, T x )
+        {
+            items[ i & ( capacity - 1 ) ].store( x, std::memory_order_relaxed );
+        }
+    };
+
+    Buffer * grow( Buffer * a, int64_t b, int64_t t )
+    {
+        auto new_buffer = std::make_unique< Buffer >( 2 * a->capacity );
+        for( int64_t i = t; i < b; ++i )
+            new_buffer->put( i, a->get( i ) );
+
+        // old buffers are kept alive until destruction,
+        // since thieves might still read from them
+        buffers.emplace_back( std::move( new_buffer ) );
+        Buffer * n = buffers.back().get();
+        buffer.store( n, std::memory_order_release );
+        return n;
+    }
+
+    // top and bottom are kept on separate cache lines,
+    // since thieves only write top and the owner mostly writes bottom
+    std::atomic< int64_t > top;
+    char pad_top[ 64 - sizeof(std::atomic< int64_t >) ];
+    std::atomic< int64_t > bottom;
+    char pad_bottom[ 64 - sizeof(std::atomic< int64_t >) ];
+    std::atomic< Buffer * > buffer;
+
+    //! only modified by the owner
+    std::vector< std::unique_ptr< Buffer > > buffers;
+};
+
+} // namespace scheduler
+
+} // namespace redGrapes
+
@@ -0,0 +1,55 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <redGrapes/dispatch/thread/topology.hpp>
+#include <redGrapes/scheduler/priority_scheduler.hpp>
+#include <redGrapes/scheduler/rank.hpp>
+
+namespace redGrapes
+{
+namespace scheduler
+{
+
+/*!
+ * PriorityScheduler which dispatches the ready task with the
+ * longest estimated remaining path first, see rank.hpp.
+ * No PriorityProperty is required.
+ *
+ * Tracking of ranks is enabled while the scheduler exists,
+ * so it has to be created before any task is emplaced.
+ * The cost history is shared by all CriticalPathSchedulers.
+ *
+ * The level of a task is fixed when it becomes ready. Tasks which
+ * are ready as soon as they are emplaced only know their own cost,
+ * the ranks pay off for tasks which wait on others.
+ */
+struct CriticalPathScheduler : PriorityScheduler< RankPriority >
+{
+    /*!
+     * @param n_levels 2 levels per doubling of the rank, starting at 256ns
+     */
+    CriticalPathScheduler(
+        size_t n_threads = dispatch::thread::default_n_workers(),
+        dispatch::thread::IdlePolicy idle_policy = dispatch::thread::IdlePolicy(),
+        dispatch::thread::PinningPolicy pinning = dispatch::thread::PinningPolicy::COMPACT,
+        unsigned n_levels = 48
+    ) :
+        PriorityScheduler< RankPriority >( n_threads, idle_policy, pinning, n_levels, RankPriority() )
+    {
+        rank::enable();
+    }
+
+    ~CriticalPathScheduler()
+    {
+        rank::disable();
+    }
+};
+
+} // namespace scheduler
+} // namespace redGrapes
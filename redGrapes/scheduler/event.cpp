@@ -18,7 +18,10 @@
 
 #include <redGrapes/scheduler/event.hpp>
 #include <redGrapes/context.hpp>
+#include <redGrapes/dispatch/thread/worker.hpp>
 #include <redGrapes/redGrapes.hpp>
+#include <redGrapes/trace/counters.hpp>
+#include <redGrapes/trace/tracer.hpp>
 
 namespace redGrapes
 {
@@ -27,16 +30,19 @@ namespace scheduler
 
 Event::Event()
     : state(1)
+    , waiter(nullptr)
 {
 }
 
 Event::Event(Event & other)
     : state((int)other.state)
+    , waiter(nullptr)
 {
 }
 
 Event::Event(Event && other)
     : state((int)other.state)
+    , waiter(nullptr)
 {    
 }
 
@@ -74,6 +80,13 @@ void Event::remove_follower( EventPtr follower )
 bool EventPtr::notify( )
 {
     SPDLOG_TRACE("notify event {}", (void*)&this->get_event() );
+    trace::ThreadCounters::add( trace::counters().event_notifications );
+
+    // the event is part of the task, which must not
+    // get removed by another thread until we are done here
+    if( task )
+        ++ task->removal_refs;
+
     int old_state = this->get_event().state.fetch_sub(1);
 
     assert( old_state > 0 );
@@ -84,7 +97,10 @@ bool EventPtr::notify( )
     {
         // pre event ready
         if( tag == scheduler::T_EVT_PRE && old_state == 2 )
+        {
+            trace::record( trace::EventKind::READY, task->task_id );
             top_scheduler->activate_task(*task);
+        }
 
         // post event or result-get event reached
         if(
@@ -102,16 +118,38 @@ bool EventPtr::notify( )
 
     if( old_state == 1 )
     {
+        // a reached event gets no new followers, so the lock only
+        // waits for a concurrent add_follower() to complete.
+        // Holding it while notifying could deadlock with init_graph(),
+        // which locks a resource and then adds followers.
+        {
+            std::unique_lock< std::shared_mutex > lock( this->get_event().followers_mutex );
+        }
+
         // notify followers
-        std::shared_lock< std::shared_mutex > lock( this->get_event().followers_mutex );
         for( auto & follower : this->get_event().followers )
             follower.notify( );
 
+        // pairs with the registration in WorkerThread::wait_for()
+        if( auto worker = this->get_event().waiter.load() )
+            worker->notify();
+
         top_scheduler->notify();
     }
 
-    if( remove_task )
+    if( task )
+    {
+        if( remove_task )
+        {
+            // no children can be added after the task finished
+            if( tag == scheduler::T_EVT_POST && task->children )
+                task->children->dec_task_count();
+
+            task->space->try_remove(*task);
+        }
+
         task->space->try_remove(*task);
+    }
 
     return old_state == 2;
 }
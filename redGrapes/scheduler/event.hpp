@@ -24,6 +24,14 @@ namespace redGrapes
 
 struct Task;
 
+namespace dispatch
+{
+namespace thread
+{
+struct WorkerThread;
+} // namespace thread
+} // namespace dispatch
+
 namespace scheduler
 {
 
@@ -52,6 +60,9 @@ struct Event
     std::vector< EventPtr > followers;
     std::shared_mutex followers_mutex;
 
+    //! worker parked in a stackless wait for this event, woken once it is reached
+    std::atomic< dispatch::thread::WorkerThread * > waiter;
+
     Event();
     Event(Event &);
     Event(Event &&);
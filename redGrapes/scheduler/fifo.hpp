@@ -8,6 +8,7 @@
 #pragma once
 
 #include <optional>
+#include <vector>
 #include <moodycamel/concurrentqueue.h>
 
 #include <redGrapes/scheduler/scheduler.hpp>
@@ -29,6 +30,9 @@ struct FIFO : public IScheduler
         ready.enqueue(&task);
     }
 
+    //! a single queue for all workers, so their nodes do not matter
+    void set_worker_nodes( std::vector< unsigned > const & ) {}
+
     /*! take a job from the ready queue
      * if none available, update 
      */
@@ -43,6 +47,11 @@ struct FIFO : public IScheduler
         }
     }
 
+    size_t queue_depth()
+    {
+        return ready.size_approx();
+    }
+
     /*! call the manager to activate tasks until we get at least
      * one in the ready queue
      */
@@ -0,0 +1,151 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <redGrapes/scheduler/scheduler.hpp>
+#include <redGrapes/scheduler/work_stealing.hpp>
+#include <redGrapes/task/task.hpp>
+#include <redGrapes/redGrapes.hpp>
+
+namespace redGrapes
+{
+namespace scheduler
+{
+
+/*!
+ * reads the priority of a task from its PriorityProperty,
+ * which has to be part of REDGRAPES_TASK_PROPERTIES
+ */
+struct TaskPriority
+{
+    template < typename T >
+    int operator() ( T const & task ) const
+    {
+        return task.priority;
+    }
+};
+
+/*!
+ * Ready-set with one bucket per priority level.
+ *
+ * Each level is a WorkStealing ready-set on its own, i.e. every worker
+ * has a deque per level, so activations and dispatches of different
+ * workers do not contend. Workers take jobs from the highest non-empty
+ * level, a counter per level lets them skip empty levels without
+ * touching the deques of other workers.
+ *
+ * Priorities are clamped to [0, n_levels).
+ *
+ * @tparam GetPriority function object which returns the priority of a task
+ */
+template < typename GetPriority = TaskPriority >
+struct PriorityWorkStealing : public IScheduler
+{
+    struct Level
+    {
+        WorkStealing ready;
+
+        //! tasks which are activated and not yet dispatched
+        alignas(64) std::atomic< int64_t > n_ready;
+
+        Level( size_t n_workers, IScheduler * pool )
+            : ready( n_workers, pool )
+            , n_ready( 0 )
+        {}
+    };
+
+    std::vector< std::unique_ptr< Level > > levels;
+    GetPriority get_priority;
+
+    PriorityWorkStealing(
+        size_t n_workers,
+        unsigned n_levels = 8,
+        GetPriority get_priority = GetPriority()
+    ) :
+        get_priority( get_priority )
+    {
+        for( unsigned i = 0; i < std::max( n_levels, 1u ); ++i )
+            levels.emplace_back( std::make_unique< Level >( n_workers, this ) );
+    }
+
+    unsigned level_of( Task const & task ) const
+    {
+        int p = get_priority( task );
+        return std::min( (unsigned) std::max( p, 0 ), (unsigned) levels.size() - 1 );
+    }
+
+    //! must be called before the workers start
+    void set_worker_nodes( std::vector< unsigned > const & nodes )
+    {
+        for( auto & level : levels )
+            level->ready.set_worker_nodes( nodes );
+    }
+
+    //! the levels share the workers, see WorkStealing::preferred_worker
+    int preferred_worker( Task const & task ) const
+    {
+        return levels[ 0 ]->ready.preferred_worker( task );
+    }
+
+    void activate_task( Task & task )
+    {
+        Level & level = *levels[ level_of( task ) ];
+        SPDLOG_TRACE("PriorityWorkStealing: activate task {} at level {}", task.task_id, level_of( task ));
+
+        // count first, so a visible task is never skipped
+        level.n_ready.fetch_add( 1, std::memory_order_relaxed );
+        level.ready.activate_task( task );
+    }
+
+    /*! take a job from the ready-set,
+     * if none available, initialize further tasks and try again
+     */
+    Task * get_job()
+    {
+        if( auto task = try_next_task() )
+            return task;
+        else
+        {
+            update_active_task_spaces();
+            return try_next_task();
+        }
+    }
+
+    Task * try_next_task()
+    {
+        for( auto it = levels.rbegin(); it != levels.rend(); ++it )
+        {
+            Level & level = **it;
+            if( level.n_ready.load( std::memory_order_relaxed ) > 0 )
+                if( Task * task = level.ready.try_next_task() )
+                {
+                    level.n_ready.fetch_sub( 1, std::memory_order_relaxed );
+                    return task;
+                }
+        }
+
+        return nullptr;
+    }
+
+    size_t queue_depth()
+    {
+        int64_t n = 0;
+        for( auto & level : levels )
+            n += level->n_ready.load( std::memory_order_relaxed );
+        return std::max( n, int64_t( 0 ) );
+    }
+};
+
+} // namespace scheduler
+} // namespace redGrapes
+
@@ -0,0 +1,61 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <redGrapes/task/task_space.hpp>
+#include <redGrapes/scheduler/priority.hpp>
+#include <redGrapes/scheduler/worker_pool.hpp>
+
+namespace redGrapes
+{
+namespace scheduler
+{
+
+/*
+ * Combines a work-stealing ready-set with priority levels
+ * and worker threads, see PriorityWorkStealing
+ */
+template < typename GetPriority = TaskPriority >
+struct PriorityScheduler : public WorkerPool< scheduler::PriorityWorkStealing< GetPriority > >
+{
+    /*!
+     * The first parameters are the same as for WorkStealingScheduler.
+     *
+     * @param n_levels number of distinct priorities,
+     *                 higher priorities are clamped to n_levels - 1
+     */
+    PriorityScheduler(
+        size_t n_threads = dispatch::thread::default_n_workers(),
+        dispatch::thread::IdlePolicy idle_policy = dispatch::thread::IdlePolicy(),
+        dispatch::thread::PinningPolicy pinning = dispatch::thread::PinningPolicy::COMPACT,
+        unsigned n_levels = 8,
+        GetPriority get_priority = GetPriority()
+    ) :
+        WorkerPool< scheduler::PriorityWorkStealing< GetPriority > >(
+            std::make_shared< scheduler::PriorityWorkStealing< GetPriority > >( n_threads, n_levels, get_priority ),
+            n_threads, idle_policy, pinning )
+    {
+    }
+
+    void activate_task( Task & task )
+    {
+        SPDLOG_TRACE("PriorityScheduler::activate_task({})", task.task_id);
+        int w = this->ready->preferred_worker( task );
+        this->ready->activate_task( task );
+
+        // one task needs only one additional worker,
+        // preferably the one which has its resources in cache
+        if( w < 0 || ! this->sleepers->wake( w ) )
+            this->sleepers->wake_one();
+    }
+};
+
+} // namespace scheduler
+
+} // namespace redGrapes
+
@@ -0,0 +1,187 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <redGrapes/scheduler/rank.hpp>
+#include <redGrapes/task/task.hpp>
+#include <redGrapes/task/task_space.hpp>
+
+namespace redGrapes
+{
+namespace scheduler
+{
+namespace rank
+{
+
+std::atomic< unsigned > n_enabled( 0 );
+
+namespace
+{
+
+/*! running average of the execution time per cost class,
+ *  split into shards so that unrelated classes do not contend
+ */
+struct CostTable
+{
+    static constexpr size_t n_shards = 64;
+
+    struct Shard
+    {
+        std::mutex m;
+        std::unordered_map< size_t, uint64_t > costs;
+    };
+
+    Shard shards[ n_shards ];
+
+    static CostTable & get()
+    {
+        static CostTable * table = new CostTable();
+        return *table;
+    }
+
+    Shard & shard( size_t cost_class )
+    {
+        // hash codes of types are often aligned
+        return shards[ ( cost_class ^ ( cost_class >> 12 ) ) % n_shards ];
+    }
+
+    uint64_t cost_of( size_t cost_class )
+    {
+        Shard & s = shard( cost_class );
+        std::lock_guard< std::mutex > lock( s.m );
+        auto it = s.costs.find( cost_class );
+        return ( it != s.costs.end() ) ? it->second : default_cost_ns;
+    }
+
+    void add_sample( size_t cost_class, uint64_t duration_ns )
+    {
+        Shard & s = shard( cost_class );
+        std::lock_guard< std::mutex > lock( s.m );
+        auto c = s.costs.find( cost_class );
+        if( c == s.costs.end() )
+            s.costs.emplace( cost_class, duration_ns );
+        else
+            // exponential moving average with weight 1/8
+            c->second = c->second - c->second / 8 + duration_ns / 8;
+    }
+
+    void clear()
+    {
+        for( Shard & s : shards )
+        {
+            std::lock_guard< std::mutex > lock( s.m );
+            s.costs.clear();
+        }
+    }
+};
+
+/*! set the rank of a task to at least `r`
+ *  and raise the ranks of the tasks before it accordingly.
+ *
+ * The mutex of a task is held while its predecessors are visited,
+ * which keeps them from being released by record_start().
+ * Locks are only taken along edges towards preceding tasks,
+ * so they can not form a cycle.
+ */
+void raise( Task & task, uint64_t r, unsigned depth )
+{
+    uint64_t old = task.upward_rank.load( std::memory_order_relaxed );
+    do
+    {
+        if( r <= old )
+            return;
+    }
+    while( ! task.upward_rank.compare_exchange_weak( old, r, std::memory_order_relaxed ) );
+
+    if( depth < max_depth )
+    {
+        std::lock_guard< std::mutex > lock( task.rank_mutex );
+        for( Task * p : task.rank_preceding )
+            raise( *p, p->rank_cost + r, depth + 1 );
+    }
+}
+
+} // namespace
+
+void enable()
+{
+    n_enabled.fetch_add( 1 );
+}
+
+void disable()
+{
+    if( n_enabled.fetch_sub( 1 ) == 1 )
+        CostTable::get().clear();
+}
+
+void record_create_slow( RankProperty & task, size_t cost_class )
+{
+    task.rank_cost_class = cost_class;
+    task.rank_cost = CostTable::get().cost_of( cost_class );
+    task.upward_rank.store( task.rank_cost, std::memory_order_relaxed );
+}
+
+void record_dependency_slow( Task & preceding_task, Task & task )
+{
+    if( preceding_task.is_finished() )
+        return;
+
+    /* the preceding task is alive since it is still listed in a resource
+     * which is locked by the initialization of `task`, but its removal
+     * might already be decided and just wait for that lock.
+     */
+    int refs = preceding_task.removal_refs.load();
+    do
+    {
+        if( refs == 0 )
+            return;
+    }
+    while( ! preceding_task.removal_refs.compare_exchange_weak( refs, refs + 1 ) );
+
+    {
+        std::lock_guard< std::mutex > lock( task.rank_mutex );
+        task.rank_preceding.push_back( &preceding_task );
+    }
+
+    raise(
+        preceding_task,
+        preceding_task.rank_cost + task.upward_rank.load( std::memory_order_relaxed ),
+        0 );
+}
+
+void record_start_slow( Task & task )
+{
+    std::vector< Task * > preceding;
+    {
+        std::lock_guard< std::mutex > lock( task.rank_mutex );
+        std::swap( preceding, task.rank_preceding );
+    }
+
+    for( Task * p : preceding )
+        p->space->try_remove( *p );
+}
+
+void record_execution_slow( RankProperty & task, uint64_t duration_ns, bool finished )
+{
+    task.rank_elapsed += duration_ns;
+
+    if( finished )
+        CostTable::get().add_sample( task.rank_cost_class, task.rank_elapsed );
+}
+
+uint64_t class_cost( size_t cost_class )
+{
+    return CostTable::get().cost_of( cost_class );
+}
+
+} // namespace rank
+} // namespace scheduler
+} // namespace redGrapes
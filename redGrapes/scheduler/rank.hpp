@@ -0,0 +1,150 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+ * @file redGrapes/scheduler/rank.hpp
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <typeinfo>
+
+#include <redGrapes/task/property/rank.hpp>
+#include <redGrapes/trace/counters.hpp>
+#include <redGrapes/trace/tracer.hpp>
+
+namespace redGrapes
+{
+
+struct Task;
+
+namespace scheduler
+{
+
+/*!
+ * Estimation of the upward rank of each unfinished task,
+ * i.e. the length of the longest path from its start to the end
+ * of the task graph known so far, as in the HEFT list scheduler.
+ * The estimate is kept in the RankProperty of the task.
+ *
+ * Every task belongs to a cost class, which is its label if it has
+ * a LabelProperty and the type of its callable otherwise. The cost of
+ * a task is the running average of the execution times in its class.
+ *
+ * A new task starts with its own cost as rank. Each dependency which
+ * GraphProperty::add_dependency inserts raises the ranks of the
+ * preceding task and, up to `max_depth` levels, of the unfinished tasks
+ * before it. A task keeps its unfinished predecessors from being removed
+ * until it starts, so following edges never touches freed tasks.
+ */
+namespace rank
+{
+
+//! number of schedulers which track ranks, see enable()
+extern std::atomic< unsigned > n_enabled;
+
+//! maximal number of edges a rank update is propagated backwards
+constexpr unsigned max_depth = 16;
+
+//! cost of a class without history
+constexpr uint64_t default_cost_ns = 1000;
+
+/*! start tracking ranks, must be called before tasks get emplaced.
+ *  Done by each CriticalPathScheduler for its lifetime.
+ */
+void enable();
+
+/*! stop tracking once every enable() is matched,
+ *  then the cost history is dropped
+ */
+void disable();
+
+inline bool enabled()
+{
+    return n_enabled.load( std::memory_order_relaxed ) > 0;
+}
+
+void record_create_slow( RankProperty & task, size_t cost_class );
+void record_dependency_slow( Task & preceding_task, Task & task );
+void record_start_slow( Task & task );
+void record_execution_slow( RankProperty & task, uint64_t duration_ns, bool finished );
+
+/*! initialize the rank of a new task,
+ *  its cost class is its label if it has a LabelProperty
+ *  and the type of its callable otherwise
+ */
+template < typename T >
+inline void record_create( T & task, std::type_info const & callable )
+{
+    if( enabled() )
+    {
+        trace::LabelID label = trace::detail::task_label( task, 0 );
+        record_create_slow(
+            task,
+            label == 0 ? callable.hash_code() : size_t( label ) );
+    }
+}
+
+//! preceding_task has to finish before task
+inline void record_dependency( Task & preceding_task, Task & task )
+{
+    if( enabled() )
+        record_dependency_slow( preceding_task, task );
+}
+
+/*! the task is about to run, so its predecessors are done
+ *  and may be removed. Done even when tracking stopped in between.
+ */
+template < typename T >
+inline void record_start( T & task )
+{
+    // only written by the task itself before it became ready
+    if( ! task.rank_preceding.empty() )
+        record_start_slow( task );
+}
+
+/*! one slice of execution, which began at `begin` (see trace::now_ns()),
+ *  once the task finished its cost class gets updated
+ */
+inline void record_execution( RankProperty & task, uint64_t begin, bool finished )
+{
+    if( enabled() )
+        record_execution_slow( task, trace::now_ns() - begin, finished );
+}
+
+//! @return running average of the execution time in a cost class
+uint64_t class_cost( size_t cost_class );
+
+} // namespace rank
+
+/*!
+ * Priority of a task in the PriorityScheduler from its upward rank,
+ * with two levels per doubling of the rank.
+ */
+struct RankPriority
+{
+    template < typename T >
+    int operator() ( T const & task ) const
+    {
+        uint64_t r = task.upward_rank.load( std::memory_order_relaxed );
+        if( r == 0 )
+            return 0;
+
+        // floor( 2 * log2(r) ), ranks below 256ns are level 0
+        int log2 = 63 - __builtin_clzll( r );
+        int half = log2 > 0 && ( r >> ( log2 - 1 ) ) == 3;
+        return std::max( 2 * log2 + half - 16, 0 );
+    }
+};
+
+} // namespace scheduler
+} // namespace redGrapes
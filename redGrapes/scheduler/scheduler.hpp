@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <optional>
 
 namespace redGrapes
@@ -39,7 +40,32 @@ struct IScheduler
     //! add task to ready set
     virtual void activate_task( Task & task ) {}
 
+    //! wakeup the main thread waiting in redGrapes::idle
     virtual void notify() {}
+
+    /*! wakeup one sleeping worker thread for work which does not
+     *  pass through activate_task(), i.e. a task space which got
+     *  scheduled for initialization
+     */
+    virtual void wake_worker() {}
+
+    //! approximate number of tasks which are ready but not yet taken
+    virtual size_t queue_depth()
+    {
+        return 0;
+    }
+
+    //! number of worker threads executing the tasks, 0 if unknown
+    virtual size_t n_workers()
+    {
+        return 0;
+    }
+
+    /*! stop and join all worker threads. Called by finalize()
+     *  once all tasks are done, after that no worker touches the
+     *  runtime anymore. The scheduler can not be used again.
+     */
+    virtual void stop() {}
 };
 
 } // namespace scheduler
@@ -122,6 +122,26 @@ namespace scheduler
                     s.s->notify();
             }
 
+            void wake_worker()
+            {
+                for(auto& s : sub_schedulers)
+                    s.s->wake_worker();
+            }
+
+            size_t n_workers()
+            {
+                size_t n = 0;
+                for(auto& s : sub_schedulers)
+                    n += s.s->n_workers();
+                return n;
+            }
+
+            void stop()
+            {
+                for(auto& s : sub_schedulers)
+                    s.s->stop();
+            }
+
             std::optional<std::shared_ptr<IScheduler>> get_matching_scheduler(
                 std::bitset<T_tag_count> const& required_tags)
             {
@@ -0,0 +1,211 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <moodycamel/concurrentqueue.h>
+
+#include <redGrapes/scheduler/scheduler.hpp>
+#include <redGrapes/scheduler/chase_lev_deque.hpp>
+#include <redGrapes/dispatch/thread/worker.hpp>
+#include <redGrapes/task/task.hpp>
+#include <redGrapes/redGrapes.hpp>
+
+namespace redGrapes
+{
+namespace scheduler
+{
+
+/*!
+ * Ready-set with one Chase-Lev deque per worker thread.
+ *
+ * Tasks which get activated inside a worker of this pool are pushed
+ * to the bottom of the workers own deque and are popped from there
+ * again (LIFO), so a successor usually runs on the same core as its
+ * predecessor. Activations from outside the pool (e.g. the main thread)
+ * go through a shared injection queue.
+ * Workers without local work steal from the top of a random victim,
+ * trying the workers on their own NUMA node before the remote ones.
+ *
+ * A task whose resources were last written by another worker of the pool
+ * goes to the mailbox of that worker instead, so it runs where its data
+ * is still cached. Mailboxes are taken from before the injection queue,
+ * and other workers steal from them only after all deques are empty.
+ */
+struct WorkStealing : public IScheduler
+{
+    struct WorkerQueue
+    {
+        ChaseLevDeque< Task* > deque;
+
+        //! tasks activated by others which prefer this worker
+        moodycamel::ConcurrentQueue< Task* > mailbox{ 0 };
+
+        //! state of the xorshift generator for victim selection
+        uint32_t seed;
+
+        //! NUMA node of the worker
+        unsigned node = 0;
+    };
+
+    std::vector< std::unique_ptr< WorkerQueue > > queues;
+    moodycamel::ConcurrentQueue< Task* > injected;
+
+    //! scheduler of the workers which own the queues
+    IScheduler * pool;
+
+    /*!
+     * @param pool scheduler the workers get their jobs from,
+     *             if this ready-set is only part of it
+     */
+    WorkStealing( size_t n_workers, IScheduler * pool = nullptr )
+        : pool( pool ? pool : this )
+    {
+        for( size_t i = 0; i < n_workers; ++i )
+        {
+            queues.emplace_back( std::make_unique< WorkerQueue >() );
+            queues.back()->seed = 0x9e3779b9u * ( i + 1 );
+        }
+    }
+
+    //! must be called before the workers start
+    void set_worker_nodes( std::vector< unsigned > const & nodes )
+    {
+        for( size_t i = 0; i < queues.size() && i < nodes.size(); ++i )
+            queues[ i ]->node = nodes[ i ];
+    }
+
+    /*! @return queue of the current thread if it is a worker
+     *          which uses this ready-set, nullptr otherwise
+     */
+    WorkerQueue * local_queue()
+    {
+        auto worker = dispatch::thread::current_worker;
+        if( worker &&
+            worker->get_scheduler().get() == pool &&
+            worker->id < queues.size() )
+            return queues[ worker->id ].get();
+        else
+            return nullptr;
+    }
+
+    /*! @return worker of this ready-set which last wrote
+     *          the resources of the task, -1 if unknown
+     */
+    int preferred_worker( Task const & task ) const
+    {
+        int w = task.last_writer();
+        return ( w >= 0 && size_t(w) < queues.size() ) ? w : -1;
+    }
+
+    void activate_task( Task & task )
+    {
+        SPDLOG_TRACE("WorkStealing: activate task {}", task.task_id);
+
+        WorkerQueue * q = local_queue();
+        int w = preferred_worker( task );
+
+        if( w >= 0 && queues[ w ].get() != q )
+            queues[ w ]->mailbox.enqueue( &task );
+        else if( q )
+            q->deque.push( &task );
+        else
+            injected.enqueue( &task );
+    }
+
+    /*! take a job from the ready-set,
+     * if none available, initialize further tasks and try again
+     */
+    Task * get_job()
+    {
+        if( auto task = try_next_task() )
+            return task;
+        else
+        {
+            update_active_task_spaces();
+            return try_next_task();
+        }
+    }
+
+    size_t queue_depth()
+    {
+        size_t n = injected.size_approx();
+        for( auto & q : queues )
+            n += q->deque.size() + q->mailbox.size_approx();
+        return n;
+    }
+
+    Task * try_next_task()
+    {
+        Task * task;
+        WorkerQueue * q = local_queue();
+
+        if( q && q->deque.pop( task ) )
+            return task;
+
+        if( q && q->mailbox.try_dequeue( task ) )
+            return task;
+
+        if( injected.try_dequeue( task ) )
+            return task;
+
+        return steal( q );
+    }
+
+    /*! try each other worker once, starting at a random victim,
+     *  first the deques on the same node, then the remote deques,
+     *  then all mailboxes
+     */
+    Task * steal( WorkerQueue * thief )
+    {
+        size_t n = queues.size();
+        if( n == 0 )
+            return nullptr;
+
+        size_t start = 0;
+        if( thief )
+        {
+            thief->seed ^= thief->seed << 13;
+            thief->seed ^= thief->seed >> 17;
+            thief->seed ^= thief->seed << 5;
+            start = thief->seed % n;
+        }
+
+        Task * task;
+        for( bool local : { true, false } )
+            for( size_t i = 0; i < n; ++i )
+            {
+                WorkerQueue * victim = queues[ ( start + i ) % n ].get();
+                bool same_node = ! thief || victim->node == thief->node;
+
+                if( victim != thief && same_node == local && victim->deque.steal( task ) )
+                {
+                    SPDLOG_TRACE("WorkStealing: stole task {}", task->task_id);
+                    return task;
+                }
+            }
+
+        // tasks waiting for a busy worker
+        for( size_t i = 0; i < n; ++i )
+        {
+            WorkerQueue * victim = queues[ ( start + i ) % n ].get();
+            if( victim != thief && victim->mailbox.try_dequeue( task ) )
+            {
+                SPDLOG_TRACE("WorkStealing: took task {} from mailbox", task->task_id);
+                return task;
+            }
+        }
+
+        return nullptr;
+    }
+};
+
+} // namespace scheduler
+} // namespace redGrapes
+
@@ -0,0 +1,51 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <redGrapes/task/task_space.hpp>
+#include <redGrapes/scheduler/work_stealing.hpp>
+#include <redGrapes/scheduler/worker_pool.hpp>
+
+namespace redGrapes
+{
+namespace scheduler
+{
+
+/*
+ * Combines a work-stealing ready-set with worker threads
+ */
+struct WorkStealingScheduler : public WorkerPool< scheduler::WorkStealing >
+{
+    WorkStealingScheduler(
+        size_t n_threads = dispatch::thread::default_n_workers(),
+        dispatch::thread::IdlePolicy idle_policy = dispatch::thread::IdlePolicy(),
+        dispatch::thread::PinningPolicy pinning = dispatch::thread::PinningPolicy::COMPACT
+    ) :
+        WorkerPool< scheduler::WorkStealing >(
+            std::make_shared< scheduler::WorkStealing >( n_threads ),
+            n_threads, idle_policy, pinning )
+    {
+    }
+
+    void activate_task( Task & task )
+    {
+        SPDLOG_TRACE("WorkStealingScheduler::activate_task({})", task.task_id);
+        int w = ready->preferred_worker( task );
+        ready->activate_task( task );
+
+        // one task needs only one additional worker,
+        // preferably the one which has its resources in cache
+        if( w < 0 || ! sleepers->wake( w ) )
+            sleepers->wake_one();
+    }
+};
+
+} // namespace scheduler
+
+} // namespace redGrapes
+
@@ -0,0 +1,128 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+ * @file redGrapes/scheduler/worker_pool.hpp
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <redGrapes/context.hpp>
+#include <redGrapes/scheduler/scheduler.hpp>
+#include <redGrapes/dispatch/thread/idle_policy.hpp>
+#include <redGrapes/dispatch/thread/topology.hpp>
+#include <redGrapes/dispatch/thread/worker.hpp>
+
+namespace redGrapes
+{
+namespace scheduler
+{
+
+/*!
+ * Worker threads which all take their tasks from one ready-set,
+ * pinned according to a PinningPolicy. Meanwhile the main thread
+ * waits in redGrapes::idle until notify() is called.
+ *
+ * Base of the schedulers which own their workers, these only
+ * decide which worker gets woken up in activate_task().
+ *
+ * @tparam ReadySet scheduler whose get_job() the workers call,
+ *         it gets the NUMA node of each worker before they start
+ */
+template < typename ReadySet >
+struct WorkerPool : public IScheduler
+{
+    std::mutex m;
+    std::condition_variable cv;
+    std::atomic_flag wait = ATOMIC_FLAG_INIT;
+
+    std::shared_ptr< ReadySet > ready;
+    std::shared_ptr< dispatch::thread::SleeperRegistry > sleepers;
+    std::vector< std::shared_ptr< dispatch::thread::WorkerThread > > threads;
+
+    WorkerPool(
+        std::shared_ptr< ReadySet > ready,
+        size_t n_threads,
+        dispatch::thread::IdlePolicy idle_policy,
+        dispatch::thread::PinningPolicy pinning
+    ) :
+        ready( ready ),
+        sleepers( std::make_shared< dispatch::thread::SleeperRegistry >() )
+    {
+        auto placement = dispatch::thread::place_workers( n_threads, pinning );
+
+        // steal from workers on the same node first
+        ready->set_worker_nodes( placement.worker_node );
+
+        for( size_t i = 0; i < n_threads; ++i )
+            threads.emplace_back( std::make_shared< dispatch::thread::WorkerThread >( ready, i, sleepers, idle_policy ) );
+
+        dispatch::thread::pin_workers( threads, placement );
+
+        // if not configured otherwise,
+        // the main thread will simply wait
+        redGrapes::idle =
+            [this]
+            {
+                SPDLOG_TRACE("WorkerPool::idle()");
+                std::unique_lock< std::mutex > l( m );
+                cv.wait( l, [this]{ return !wait.test_and_set(); } );
+            };
+    }
+
+    ~WorkerPool()
+    {
+        // stop all workers before any of them gets destroyed,
+        // since they might still wake each other up
+        dispatch::thread::stop_workers( threads );
+    }
+
+    size_t queue_depth()
+    {
+        return ready->queue_depth();
+    }
+
+    size_t n_workers()
+    {
+        return threads.size();
+    }
+
+    void stop()
+    {
+        dispatch::thread::stop_workers( threads );
+    }
+
+    /*! wakeup the main thread.
+     *  Workers are only woken by activate_task() and wake_worker(),
+     *  so that reached events and removed tasks never touch them.
+     */
+    void notify()
+    {
+        SPDLOG_TRACE("WorkerPool::notify()");
+        {
+            std::unique_lock< std::mutex > l( m );
+            wait.clear();
+        }
+        cv.notify_one();
+    }
+
+    //! wakeup one sleeping worker thread
+    void wake_worker()
+    {
+        sleepers->wake_one();
+    }
+};
+
+} // namespace scheduler
+} // namespace redGrapes
+
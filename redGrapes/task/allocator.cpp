@@ -6,61 +6,383 @@
  */
 
 #include <cstdlib>
-#include <atomic>
+#include <cassert>
+#include <new>
+#include <algorithm>
+#include <unordered_map>
+#include <redGrapes/dispatch/thread/topology.hpp>
 #include <redGrapes/task/allocator.hpp>
-#include <cstring>
 
 namespace redGrapes
 {
 namespace memory
 {
 
-Chunk::Chunk( size_t capacity )
-    : capacity( capacity )
-    , base( (uintptr_t) malloc(capacity) )
+static size_t round_up( size_t n, size_t align )
 {
-    reset();
+    return ( n + align - 1 ) & ~( align - 1 );
+}
+
+constexpr int64_t Chunk::active_bias;
+
+static std::atomic< int64_t > n_chunks( 0 );
+
+int64_t chunks_in_use()
+{
+    return n_chunks.load( std::memory_order_relaxed );
+}
+
+unsigned current_thread_index()
+{
+    static std::atomic< unsigned > next_index( 1 );
+    thread_local unsigned index = next_index.fetch_add( 1 );
+    return index;
+}
+
+Chunk::Chunk( unsigned owner_thread, unsigned node, size_t n_bytes, size_t slot_size )
+    : owner_thread( owner_thread )
+    , node( node )
+    , n_bytes( n_bytes )
+    , slot_size( slot_size )
+    , refs( active_bias )
+    , free_list( nullptr )
+    , remote_free_list( nullptr )
+    , bump( (uintptr_t)this + header_size() )
+{
+    n_chunks.fetch_add( 1, std::memory_order_relaxed );
 }
 
 Chunk::~Chunk()
 {
-    free( (void*)base );
+    n_chunks.fetch_sub( 1, std::memory_order_relaxed );
 }
 
-bool Chunk::empty() const
+size_t Chunk::header_size()
 {
-    return (count == 0);
+    return round_up( sizeof(Chunk), slot_alignment );
 }
 
-void Chunk::reset()
+bool Chunk::contains( void * ptr ) const
 {
-    offset = 0;
-    count = 0;
-    memset((void*)base, 0, capacity);
+    return (uintptr_t)ptr >= (uintptr_t)this + header_size()
+        && (uintptr_t)ptr < (uintptr_t)this + n_bytes;
 }
 
-void * Chunk::m_alloc( size_t n_bytes )
+void * Chunk::m_alloc()
 {
-    std::ptrdiff_t old_offset = offset.fetch_add(n_bytes);
-    if( old_offset + n_bytes <= capacity )
+    void * ptr = free_list;
+
+    // take over everything other threads freed so far
+    if( ! ptr )
+        ptr = remote_free_list.exchange( nullptr, std::memory_order_acquire );
+
+    if( ptr )
+        free_list = *(void**)ptr;
+    else if( bump + slot_size <= (uintptr_t)this + n_bytes )
     {
-        count.fetch_add(1);
-        return (void*)(base + old_offset);
+        ptr = (void*) bump;
+        bump += slot_size;
     }
     else
         return nullptr;
+
+    refs.fetch_add( 1, std::memory_order_relaxed );
+    return ptr;
+}
+
+bool Chunk::m_free( void * ptr )
+{
+    assert( contains( ptr ) );
+
+    // ptr might point to a base class subobject
+    uintptr_t first = (uintptr_t)this + header_size();
+    void * slot = (void*)( first + ( ( (uintptr_t)ptr - first ) / slot_size ) * slot_size );
+
+    if( owner_thread == current_thread_index() )
+    {
+        *(void**)slot = free_list;
+        free_list = slot;
+    }
+    else
+    {
+        void * head = remote_free_list.load( std::memory_order_relaxed );
+        do
+            *(void**)slot = head;
+        while( ! remote_free_list.compare_exchange_weak(
+                   head, slot,
+                   std::memory_order_release,
+                   std::memory_order_relaxed ) );
+    }
+
+    return refs.fetch_sub( 1, std::memory_order_acq_rel ) == 1;
+}
+
+bool Chunk::retire()
+{
+    return refs.fetch_sub( active_bias, std::memory_order_acq_rel ) == active_bias;
+}
+
+static void release_chunk( Chunk * chunk )
+{
+    size_t n_bytes = chunk->n_bytes;
+    unsigned node = chunk->node;
+    chunk->~Chunk();
+    ChunkPool::release( (void*)chunk, n_bytes, node );
+}
+
+namespace
+{
+
+/*! key of the pool of chunks with n_bytes on a node,
+ *  chunk sizes are powers of two of at least 4 KiB,
+ *  so the node fits into the lower bits
+ */
+size_t pool_key( size_t n_bytes, unsigned node )
+{
+    return n_bytes | ( node & 0xfff );
+}
+
+struct GlobalChunkPool
+{
+    std::mutex m;
+    std::unordered_map< size_t, std::vector< void * > > chunks;
+
+    static GlobalChunkPool & get()
+    {
+        // never destroyed, since threads which exit late
+        // still return the chunks of their cache
+        static GlobalChunkPool * pool = new GlobalChunkPool();
+        return *pool;
+    }
+
+    void * acquire( size_t key )
+    {
+        std::lock_guard< std::mutex > lock( m );
+        auto & free_chunks = chunks[ key ];
+        if( free_chunks.empty() )
+            return nullptr;
+
+        void * chunk = free_chunks.back();
+        free_chunks.pop_back();
+        return chunk;
+    }
+
+    void release( void * chunk, size_t key )
+    {
+        std::lock_guard< std::mutex > lock( m );
+        chunks[ key ].push_back( chunk );
+    }
+};
+
+//! set once the cache of this thread got destroyed at thread exit
+thread_local bool thread_chunk_cache_destroyed = false;
+
+struct ThreadChunkCache
+{
+    static constexpr size_t capacity = 8;
+
+    //! pool key and chunk
+    std::vector< std::pair< size_t, void * > > chunks;
+
+    ~ThreadChunkCache()
+    {
+        for( auto & c : chunks )
+            GlobalChunkPool::get().release( c.second, c.first );
+
+        thread_chunk_cache_destroyed = true;
+    }
+};
+
+thread_local ThreadChunkCache thread_chunk_cache;
+
+} // namespace
+
+void * ChunkPool::acquire( size_t n_bytes, unsigned node )
+{
+    size_t key = pool_key( n_bytes, node );
+
+    if( ! thread_chunk_cache_destroyed )
+    {
+        auto & cache = thread_chunk_cache.chunks;
+        for( auto it = cache.rbegin(); it != cache.rend(); ++it )
+            if( it->first == key )
+            {
+                void * chunk = it->second;
+                cache.erase( std::next( it ).base() );
+                return chunk;
+            }
+    }
+
+    if( void * chunk = GlobalChunkPool::get().acquire( key ) )
+        return chunk;
+
+    void * chunk = nullptr;
+    if( posix_memalign( &chunk, n_bytes, n_bytes ) != 0 )
+        throw std::bad_alloc();
+
+    return chunk;
+}
+
+void ChunkPool::release( void * chunk, size_t n_bytes, unsigned node )
+{
+    size_t key = pool_key( n_bytes, node );
+
+    if( ! thread_chunk_cache_destroyed &&
+        thread_chunk_cache.chunks.size() < ThreadChunkCache::capacity )
+        thread_chunk_cache.chunks.emplace_back( key, chunk );
+    else
+        GlobalChunkPool::get().release( chunk, key );
+}
+
+namespace
+{
+
+//! set once the arenas of this thread got destroyed at thread exit
+thread_local bool thread_arenas_destroyed = false;
+
+struct ThreadArenas
+{
+    std::vector< std::unique_ptr< Arena > > arenas;
+
+    ~ThreadArenas()
+    {
+        arenas.clear();
+        thread_arenas_destroyed = true;
+    }
+
+    Arena & get( size_t chunk_size )
+    {
+        for( auto & arena : arenas )
+            if( arena->chunk_size == chunk_size )
+                return *arena;
+
+        arenas.emplace_back( std::make_unique< Arena >( chunk_size ) );
+        return *arenas.back();
+    }
+};
+
+thread_local ThreadArenas thread_arenas;
+
+} // namespace
+
+Arena::Arena( size_t chunk_size )
+    : chunk_size( chunk_size )
+{
 }
 
-unsigned Chunk::m_free( void * )
+Arena::~Arena()
 {
-    return count.fetch_sub(1) - 1;
+    for( Chunk * chunk : active )
+        if( chunk && chunk->retire() )
+            release_chunk( chunk );
 }
 
-bool Chunk::contains( void * ptr )
+void * Arena::m_alloc( unsigned size_class, size_t slot_size )
 {
-    return (uintptr_t)ptr >= (uintptr_t)base && (uintptr_t)ptr < (uintptr_t)(base + capacity);
+    if( size_class >= active.size() )
+        active.resize( size_class + 1, nullptr );
+
+    Chunk * & chunk = active[ size_class ];
+    if( chunk )
+    {
+        if( void * ptr = chunk->m_alloc() )
+            return ptr;
+
+        // full, the remaining slots are released by their last free
+        if( chunk->retire() )
+            release_chunk( chunk );
+    }
+
+    unsigned node = dispatch::thread::Topology::get().current_node();
+    chunk = new ( ChunkPool::acquire( chunk_size, node ) ) Chunk( current_thread_index(), node, chunk_size, slot_size );
+    return chunk->m_alloc();
+}
+
+Allocator::Allocator( size_t chunk_size )
+    : chunk_size( [chunk_size] {
+          // must be a power of two and hold at least a few slots
+          size_t n = 0x1000;
+          while( n < chunk_size )
+              n <<= 1;
+          return n;
+      }() )
+{
+    // 64 byte steps for small tasks, then doubling
+    size_t slot_size = slot_alignment;
+    for( ; slot_size <= std::min( size_t(1024), max_slot_size() ); slot_size += slot_alignment )
+        slot_sizes.push_back( slot_size );
+
+    for( slot_size = 2048; slot_size < max_slot_size(); slot_size <<= 1 )
+        slot_sizes.push_back( slot_size );
+
+    if( slot_sizes.back() < max_slot_size() )
+        slot_sizes.push_back( max_slot_size() );
+}
+
+size_t Allocator::max_slot_size() const
+{
+    // at least eight slots per chunk
+    return ( ( chunk_size - Chunk::header_size() ) / 8 ) & ~( slot_alignment - 1 );
+}
+
+void * Allocator::m_alloc( size_t n_bytes )
+{
+    if( n_bytes > max_slot_size() || thread_arenas_destroyed )
+        return m_alloc_large( n_bytes );
+
+    auto it = std::lower_bound( std::begin( slot_sizes ), std::end( slot_sizes ), n_bytes );
+    assert( it != std::end( slot_sizes ) );
+
+    return thread_arenas.get( chunk_size ).m_alloc( it - std::begin( slot_sizes ), *it );
+}
+
+void Allocator::m_alloc( size_t n_bytes, size_t n, void ** ptrs )
+{
+    if( n_bytes > max_slot_size() || thread_arenas_destroyed )
+    {
+        for( size_t i = 0; i < n; ++i )
+            ptrs[ i ] = m_alloc_large( n_bytes );
+        return;
+    }
+
+    auto it = std::lower_bound( std::begin( slot_sizes ), std::end( slot_sizes ), n_bytes );
+    assert( it != std::end( slot_sizes ) );
+
+    Arena & arena = thread_arenas.get( chunk_size );
+    for( size_t i = 0; i < n; ++i )
+        ptrs[ i ] = arena.m_alloc( it - std::begin( slot_sizes ), *it );
+}
+
+void * Allocator::m_alloc_large( size_t n_bytes )
+{
+    // the slot still starts in the first chunk_size bytes
+    // so that chunk_of() finds the header
+    size_t n = round_up( Chunk::header_size() + n_bytes, chunk_size );
+    void * mem = nullptr;
+    if( posix_memalign( &mem, chunk_size, n ) != 0 )
+        throw std::bad_alloc();
+
+    Chunk * chunk = new ( mem ) Chunk( 0, 0, n, n - Chunk::header_size() );
+    void * ptr = chunk->m_alloc();
+    chunk->retire();
+    return ptr;
+}
+
+void Allocator::m_free( void * ptr )
+{
+    Chunk * chunk = chunk_of( ptr );
+
+    if( chunk->m_free( ptr ) )
+    {
+        if( chunk->owner_thread )
+            release_chunk( chunk );
+        else
+        {
+            chunk->~Chunk();
+            free( (void*)chunk );
+        }
+    }
 }
 
 } // namespace memory
 } // namespace redGrapes
-
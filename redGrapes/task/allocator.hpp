@@ -18,87 +18,175 @@ namespace redGrapes
 namespace memory
 {
 
+//! alignment of every slot, so no two tasks share a cache line
+constexpr size_t slot_alignment = 64;
+
+//! unique, never reused, index of the calling thread, starting at 1
+unsigned current_thread_index();
+
+//! number of chunks which are currently not returned to a pool
+int64_t chunks_in_use();
+
+/*!
+ * Header at the beginning of every chunk.
+ *
+ * Chunks are aligned to the chunk size of their allocator,
+ * so the chunk owning some pointer is found by masking its lower bits.
+ * The remaining memory is divided into slots of equal size.
+ *
+ * Only the owning thread allocates from a chunk. Slots freed by the
+ * owner go to a plain free-list, slots freed by other threads are
+ * pushed to an atomic list which the owner takes over as a whole
+ * once its own free-list ran dry.
+ */
 struct Chunk
 {
-    Chunk( size_t capacity );
+    Chunk( unsigned owner_thread, unsigned node, size_t n_bytes, size_t slot_size );
     Chunk( Chunk const & ) = delete;
-    Chunk( Chunk & ) = delete;
     ~Chunk();
-    
-    bool empty() const;
-    void reset();
 
-    void * m_alloc( size_t n_bytes );
-    unsigned m_free( void * );
+    //! thread which allocates from this chunk, 0 for a large allocation
+    unsigned const owner_thread;
+
+    //! NUMA node of the owner when the chunk was acquired
+    unsigned const node;
+
+    //! total size of the chunk including this header
+    size_t const n_bytes;
+    size_t const slot_size;
+
+    static size_t header_size();
+
+    bool contains( void * ) const;
 
-    bool contains( void * );
+    /*! may only be called by the owner
+     * @return free slot or nullptr if the chunk is full
+     */
+    void * m_alloc();
+
+    /*! may be called by any thread
+     * @return true if the chunk is retired and now empty,
+     *         the caller has to release it
+     */
+    bool m_free( void * );
+
+    /*! the owner will not allocate from this chunk anymore
+     * @return true if the chunk is empty, the caller has to release it
+     */
+    bool retire();
 
 private:
-    size_t capacity;
+    //! allocated slots, plus active_bias until the owner retires the chunk
+    std::atomic< int64_t > refs;
+    static constexpr int64_t active_bias = int64_t(1) << 40;
+
+    //! slots freed by the owner, linked through their first word
+    void * free_list;
+
+    //! slots freed by other threads
+    std::atomic< void * > remote_free_list;
+
+    //! begin of the never used memory
+    uintptr_t bump;
+};
+
+/*!
+ * Keeps emptied chunks for reuse instead of returning them to the system.
+ * Each thread first fills a small cache of its own before
+ * handing chunks over to a global pool.
+ *
+ * Chunks are pooled per NUMA node and only handed out again on the
+ * node they came from. New chunks are first touched by the allocating
+ * thread, so their pages end up on its node.
+ */
+struct ChunkPool
+{
+    //! @return memory of n_bytes aligned to n_bytes, local to `node`
+    static void * acquire( size_t n_bytes, unsigned node );
+    static void release( void * chunk, size_t n_bytes, unsigned node );
+};
+
+/*!
+ * The chunks one thread currently allocates from, one per size class.
+ * Each thread has one arena per chunk size, which is shared by all
+ * allocators with that chunk size.
+ */
+struct Arena
+{
+    size_t const chunk_size;
+
+    Arena( size_t chunk_size );
+    Arena( Arena const & ) = delete;
+
+    //! retires all chunks, they get released once their last slot is freed
+    ~Arena();
 
-    uintptr_t base;
-    std::atomic_ptrdiff_t offset;
+    void * m_alloc( unsigned size_class, size_t slot_size );
 
-    std::atomic<unsigned> count;
+private:
+    std::vector< Chunk * > active;
 };
 
+/*!
+ * Slab allocator for tasks.
+ *
+ * Requests are rounded up to one of a few size classes and served
+ * from the arena of the calling thread, so concurrent emplacements
+ * do not contend. Requests which are too large to fit a reasonable
+ * number of times into one chunk get a chunk of their own.
+ */
 struct Allocator
 {
-    size_t chunk_size;
+    //! size and alignment of each chunk, always a power of two
+    size_t const chunk_size;
 
-    std::mutex m;
-    std::vector< std::unique_ptr<Chunk> > blocked_chunks;
-    std::unique_ptr<Chunk> active_chunk;
+    Allocator( size_t chunk_size = default_chunk_size() );
+    Allocator( Allocator const & ) = delete;
 
-    Allocator()
-        : chunk_size(0x1000)
-        , active_chunk( std::make_unique<Chunk>(chunk_size) )
-    {}
+    /*! chunk size of allocators which get created afterwards,
+     *  can be set before redGrapes::init()
+     */
+    static size_t & default_chunk_size()
+    {
+        static size_t chunk_size = 0x10000;
+        return chunk_size;
+    }
+
+    void * m_alloc( size_t n_bytes );
+    void m_free( void * ptr );
+
+    /*! allocate `n` slots of `n_bytes` each, with one size class
+     *  and arena lookup. They are freed one by one with m_free().
+     */
+    void m_alloc( size_t n_bytes, size_t n, void ** ptrs );
 
     template <typename T>
     T * m_alloc()
     {
-        T * item = (T*) active_chunk->m_alloc( sizeof(T) );
-
-        if( !item )
-        {
-            // create new chunk & try again
-            {
-                std::lock_guard<std::mutex> lock(m);               
-                blocked_chunks.emplace_back(std::make_unique<Chunk>( chunk_size ));
-                std::swap(active_chunk, blocked_chunks[blocked_chunks.size()-1]);
-            }
-            item = (T*) active_chunk->m_alloc( sizeof(T) );
-        }
-
-        return item;
+        static_assert( alignof(T) <= slot_alignment, "Allocator: alignment too large" );
+        return (T*) m_alloc( sizeof(T) );
     }
 
     template < typename T >
     void m_free( T * ptr )
     {
-        if( active_chunk->contains((void*)ptr) )
-            active_chunk->m_free((void*)ptr);
-
-        else
-        {
-            std::lock_guard<std::mutex> lock(m);
-
-            // find chunk containing ptr
-            for( unsigned i = 0; i < blocked_chunks.size(); ++i )
-            {
-                Chunk & c = *blocked_chunks[i];
-
-                if( c.contains((void*)ptr) )
-                {
-                    if( c.m_free( (void*) ptr ) == 0 )
-                        blocked_chunks.erase(std::begin(blocked_chunks)+i);
-
-                    break;
-                }
-            }
-        }
+        m_free( (void*) ptr );
+    }
+
+    //! @return chunk which contains the memory at ptr
+    Chunk * chunk_of( void * ptr ) const
+    {
+        return (Chunk*) ( (uintptr_t)ptr & ~(uintptr_t)(chunk_size - 1) );
     }
+
+private:
+    //! ascending slot size of each size class
+    std::vector< size_t > slot_sizes;
+
+    //! slots larger than this get their own chunk
+    size_t max_slot_size() const;
+
+    void * m_alloc_large( size_t n_bytes );
 };
 
 } // namespace memory
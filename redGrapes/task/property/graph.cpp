@@ -5,23 +5,40 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 
+#include <algorithm>
 #include <memory>
+#include <mutex>
 #include <unordered_set>
+#include <vector>
 
 #include <redGrapes/scheduler/event.hpp>
 #include <redGrapes/task/property/graph.hpp>
+#include <redGrapes/task/replay.hpp>
 #include <redGrapes/task/task_space.hpp>
 #include <redGrapes/task/task.hpp>
 #include <redGrapes/context.hpp>
 #include <redGrapes/resource/resource_user.hpp>
+#include <redGrapes/trace/counters.hpp>
+#include <redGrapes/trace/profiler.hpp>
+#include <redGrapes/scheduler/rank.hpp>
 
 namespace redGrapes
 {
 
-GraphProperty::GraphProperty() {}
+GraphProperty::GraphProperty()
+    : removal_refs(2)
+    , replay(nullptr)
+    , replay_index(0)
+    , batch_next(nullptr)
+{}
+
 GraphProperty::GraphProperty(GraphProperty const & other)
     : scope_depth(other.scope_depth)
     , space(other.space)
+    , removal_refs(2)
+    , replay(other.replay)
+    , replay_index(other.replay_index)
+    , batch_next(nullptr)
 {}
 
 bool GraphProperty::is_ready() { return pre_event.is_ready(); }
@@ -65,55 +82,254 @@ scheduler::EventPtr GraphProperty::make_event()
 void GraphProperty::sg_pause( scheduler::EventPtr event )
 {
     //SPDLOG_TRACE("sg pause: new_event = {}", (void*) event.get());
-    pre_event.state = 1;
+
+    // one extra count is held until the caller notifies the pre-event,
+    // so that reaching `event` concurrently can not activate the task before
+    pre_event.state = 2;
     event->add_follower( get_pre_event() );
 }
 
+/*!
+ * Drop the holes from the task list of a resource
+ * once they make up most of it.
+ *
+ * The list is assumed to be locked.
+ */
+static void compact_resource_users( ResourceBase const & resource )
+{
+    ResourceUsers & users = *resource.users;
+    if( users.n_holes < 32 || 2 * users.n_holes < users.tasks.size() )
+        return;
+
+    unsigned n = 0;
+    for( Task * task : users.tasks )
+        if( task )
+        {
+            task->get_resource_entry( resource.id )->task_idx = n;
+
+            users.tasks[ n++ ] = task;
+        }
+
+    users.tasks.resize( n );
+    users.n_holes = 0;
+}
+
+/*!
+ * Search the task list of one resource backwards from `end`
+ * and add the dependencies of this task, as described at init_graph().
+ *
+ * The list is assumed to be locked.
+ */
+void GraphProperty::add_dependencies( ResourceEntry & r, size_t end )
+{
+    ResourceUsers & users = *r.resource.users;
+
+    for( int i = int(end) - 1; i >= 0; --i )
+    {
+        Task * preceding_task = users.tasks[ i ];
+        if( preceding_task == nullptr )
+            continue;
+
+        if( preceding_task == this->space->parent )
+            break;
+
+        if( preceding_task->space != this->space ||
+            ! space->is_serial( *preceding_task, *this->task ) )
+            continue;
+
+        add_dependency( *preceding_task );
+
+        if( ResourceUser::is_serial( *preceding_task, *this->task, r.resource.id ) )
+        {
+            bool covered = ResourceUser::is_superset( *preceding_task, *this->task, r.resource.id );
+
+            if( ResourceUser::is_superset( *this->task, *preceding_task, r.resource.id ) )
+            {
+                preceding_task->get_resource_entry( r.resource.id )->task_idx = -1;
+
+                users.tasks[ i ] = nullptr;
+                users.n_holes++;
+            }
+
+            if( covered )
+                break;
+        }
+    }
+}
+
 /*!
  * Insert a new task and add the same dependencies as in the precedence graph.
  * Note that tasks must be added in order, since only preceding tasks are considered!
  *
- * The precedence graph containing the task is assumed to be locked.
+ * The task list of each resource is searched from the newest task backwards.
+ * Once a task is found whose accesses to the resource are serial to
+ * and cover those of the new task, all older conflicts are already ordered
+ * before that task, so the search stops there. In turn, older tasks covered
+ * by the new task are removed from the list, since every later task which
+ * conflicts with them will also conflict with the new task.
+ * This way only the frontier of the resource (e.g. the last writer and the
+ * readers since then) is visited, instead of its whole history.
+ * Both rules assume that is_serial() is monotone in is_superset_of(),
+ * which holds for all provided access policies.
+ *
+ * The task lists of all resources are locked at once, in the order of
+ * the resource ids (unique_resources is sorted). So concurrent insertions,
+ * e.g. with TaskSpace::eager_init, see each other in the same order on
+ * every resource they share and can not form a cycle.
+ *
+ * Tasks of a replayed TaskGraph take their dependencies from the
+ * precomputed ReplayPlan instead, as long as no other task got inserted
+ * into the task lists of their resources since the previous task of the
+ * same replay.
  */
 void GraphProperty::init_graph()
 {
     SPDLOG_TRACE("sg init task {}", this->task->task_id);
 
+    std::vector< std::unique_lock< std::mutex > > locks;
+    locks.reserve( this->task->unique_resources.size() );
+    for( ResourceEntry & r : this->task->unique_resources )
+        locks.emplace_back( r.resource.users->mutex );
+
+    bool from_plan = false;
+    if( replay )
+    {
+        replay->tasks[ replay_index ] = this->task;
+        from_plan = replay->use_plan( replay_index, this->task->unique_resources );
+        if( from_plan )
+        {
+            trace::ThreadCounters::add( trace::counters().replay_plan_hits );
+            add_dependencies_from_plan();
+        }
+        else if( replay->plan->nodes[ replay_index ].covered )
+            trace::ThreadCounters::add( trace::counters().replay_plan_misses );
+    }
+
     for( ResourceEntry & r : this->task->unique_resources )
     {
-        std::lock_guard< std::mutex > lock(r.resource.tasks->first);
+        ResourceUsers & users = *r.resource.users;
+
+        // the plan already provided the dependencies
+        if( ! from_plan )
+            add_dependencies( r, users.tasks.size() );
+
+        r.task_idx = users.tasks.size();
+        users.tasks.push_back(this->task);
+        users.n_inserted++;
+
+        compact_resource_users( r.resource );
+    }
+
+    if( replay )
+        replay->inserted( replay_index, this->task->unique_resources );
+}
+
+/*!
+ * Insert a batch of tasks, as created by TaskSpace::emplace_task_range(),
+ * which are usually independent of each other.
+ *
+ * The task lists of the union of their resources are locked once.
+ * Each task searches the part of the lists which precedes the batch
+ * as in init_graph(), and is then compared with the earlier tasks of the
+ * batch which share a resource with it, so that overlapping tiles are
+ * still ordered. These are compared directly, without the early stop of
+ * add_dependencies(), since disjoint tiles never cover each other.
+ * Removing dominated entries stays correct: if a task of the batch
+ * covers an older entry, every later task of the batch which conflicts
+ * with that entry also conflicts with the covering task, and gets an
+ * edge to it from the comparison within the batch.
+ */
+void GraphProperty::init_graph_batch( std::vector< Task * > const & batch )
+{
+    // one entry per resource, in the order of the resource ids
+    std::vector< ResourceEntry * > resources;
+    for( Task * task : batch )
+        for( ResourceEntry & r : task->unique_resources )
+            resources.push_back( &r );
+
+    auto by_id = []( ResourceEntry const * a, ResourceEntry const * b ) { return a->resource.id < b->resource.id; };
+    std::sort( resources.begin(), resources.end(), by_id );
+    resources.erase(
+        std::unique( resources.begin(), resources.end(),
+            []( ResourceEntry const * a, ResourceEntry const * b ) { return a->resource.id == b->resource.id; } ),
+        resources.end() );
+
+    std::vector< std::unique_lock< std::mutex > > locks;
+    locks.reserve( resources.size() );
+    for( ResourceEntry * r : resources )
+        locks.emplace_back( r->resource.users->mutex );
+
+    // the lists are not compacted before the whole batch is inserted,
+    // so the entries preceding the batch keep their indices
+    std::vector< size_t > end;
+    end.reserve( resources.size() );
+    for( ResourceEntry * r : resources )
+        end.push_back( r->resource.users->tasks.size() );
+
+    for( Task * task : batch )
+    {
+        SPDLOG_TRACE("sg init task {}", task->task_id);
 
-        for( Task * preceding_task : r.resource.tasks->second )
+        for( ResourceEntry & r : task->unique_resources )
         {
-            if( preceding_task != nullptr )
-            {
-                if( preceding_task == this->space->parent )
-                    break;
-
-                if(
-                   preceding_task->space == this->space &&
-                   space->is_serial( *preceding_task, *this->task )
-                )
-                    add_dependency( *preceding_task );
-            }
+            ResourceUsers & users = *r.resource.users;
+            size_t k = std::lower_bound( resources.begin(), resources.end(), &r, by_id ) - resources.begin();
+
+            task->add_dependencies( r, end[ k ] );
+
+            // the entries behind `end` are the earlier tasks of the batch
+            for( size_t i = end[ k ]; i < users.tasks.size(); ++i )
+                if( ResourceUser::is_serial( *users.tasks[ i ], *task, r.resource.id ) )
+                    task->add_dependency( *users.tasks[ i ] );
+
+            r.task_idx = users.tasks.size();
+            users.tasks.push_back( task );
+            users.n_inserted++;
         }
+    }
+
+    for( ResourceEntry * r : resources )
+        compact_resource_users( r->resource );
+}
+
+/*!
+ * Part of init_graph() for a task of a replay whose plan is valid:
+ * the edges and the entries it dominates are known,
+ * so the task lists need not be searched.
+ */
+void GraphProperty::add_dependencies_from_plan()
+{
+    ReplayPlan::Node const & node = replay->plan->nodes[ replay_index ];
+
+    for( unsigned p : node.preceding )
+        add_dependency( *replay->tasks[ p ] );
 
-        r.task_idx = r.resource.tasks->second.size();
-        r.resource.tasks->second.push_back(this->task);
+    for( auto const & d : node.dominated )
+    {
+        ResourceEntry * entry = replay->tasks[ d.first ]->get_resource_entry( d.second );
+        if( entry->task_idx != -1 )
+        {
+            entry->resource.users->tasks[ entry->task_idx ] = nullptr;
+            entry->resource.users->n_holes++;
+            entry->task_idx = -1;
+        }
     }
-    
-    // add dependency to parent
-    if( auto parent = this->space->parent )
-        parent->post_event.add_follower( this->get_post_event() );
 }
 
 void GraphProperty::delete_from_resources()
 {
-    for( ResourceEntry r : this->task->unique_resources )
+    for( ResourceEntry & r : this->task->unique_resources )
     {
-        std::lock_guard< std::mutex > lock(r.resource.tasks->first);
+        ResourceUsers & users = *r.resource.users;
+        std::lock_guard< std::mutex > lock( users.mutex );
         if( r.task_idx != -1 )
-            r.resource.tasks->second[ r.task_idx ] = nullptr;
+        {
+            users.tasks[ r.task_idx ] = nullptr;
+            users.n_holes++;
+            r.task_idx = -1;
+
+            compact_resource_users( r.resource );
+        }
     }
 }
 
@@ -121,6 +337,8 @@ void GraphProperty::add_dependency( Task & preceding_task )
 {
     // precedence graph
     in_edges.push_back(&preceding_task);
+    profiler::record_dependency( preceding_task.task_id, this->task->task_id );
+    scheduler::rank::record_dependency( preceding_task, *this->task );
 
     // scheduling graph
     auto preceding_event =
@@ -25,6 +25,8 @@ namespace redGrapes
 
 struct Task;
 struct TaskSpace;
+struct ReplayInstance;
+struct ResourceEntry;
 
 /*!
  * Each task associates with two events:
@@ -81,6 +83,26 @@ struct GraphProperty
     scheduler::Event result_set_event;
     scheduler::Event result_get_event;
 
+    /*! references which delay the removal of this task:
+     *  its post-event, its result-get-event, its children
+     *  and events of the task which are currently notified
+     */
+    std::atomic< int > removal_refs;
+
+    /*! replay of a TaskGraph this task belongs to, may be null.
+     *  TaskSpace::emplace_task() takes one more removal reference for it,
+     *  which is dropped once all tasks of the replay are initialized.
+     */
+    ReplayInstance * replay;
+
+    //! index of this task in the recorded TaskGraph
+    unsigned replay_index;
+
+    /*! next task of the batch this task leads, see TaskSpace::emplace_task_range().
+     *  Only the first task of a batch goes through the emplacement queue.
+     */
+    Task * batch_next;
+
     scheduler::EventPtr get_pre_event();
     scheduler::EventPtr get_post_event();
     scheduler::EventPtr get_result_set_event();
@@ -108,6 +130,14 @@ struct GraphProperty
      * The precedence graph containing the task is assumed to be locked.
      */
     void init_graph();
+    void add_dependencies( ResourceEntry & r, size_t end );
+    void add_dependencies_from_plan();
+
+    /*! insert tasks which are mostly independent of each other at once,
+     *  conflicting tasks of the batch are ordered by their position
+     *  @param batch tasks in the order of their creation
+     */
+    static void init_graph_batch( std::vector< Task * > const & batch );
     void add_dependency( Task & preceding_task );
     void update_graph();
     void delete_from_resources();
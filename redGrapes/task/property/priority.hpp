@@ -0,0 +1,82 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+ * @file redGrapes/task/property/priority.hpp
+ */
+
+#pragma once
+
+#include <fmt/format.h>
+
+namespace redGrapes
+{
+
+/*!
+ * Priority of a task, ready tasks with a higher priority
+ * are dispatched first by the PriorityScheduler.
+ */
+struct PriorityProperty
+{
+    int priority;
+
+    PriorityProperty()
+        : priority( 0 )
+    {}
+
+    template < typename PropertiesBuilder >
+    struct Builder
+    {
+        PropertiesBuilder & builder;
+
+        Builder( PropertiesBuilder & b )
+            : builder(b)
+        {}
+
+        PropertiesBuilder priority( int p )
+        {
+            builder.prop.priority = p;
+            return builder;
+        }
+    };
+
+    struct Patch
+    {
+        template <typename PatchBuilder>
+        struct Builder
+        {
+            Builder( PatchBuilder & ) {}
+        };
+    };
+
+    void apply_patch( Patch const & ) {};
+};
+
+} // namespace redGrapes
+
+template <>
+struct fmt::formatter< redGrapes::PriorityProperty >
+{
+    constexpr auto parse( format_parse_context& ctx )
+    {
+        return ctx.begin();
+    }
+
+    template < typename FormatContext >
+    auto format(
+        redGrapes::PriorityProperty const & prio_prop,
+        FormatContext & ctx
+    )
+    {
+        return format_to(
+                   ctx.out(),
+                   "\"priority\" : {}",
+                   prio_prop.priority
+               );
+    }
+};
+
@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <atomic>
+
 namespace redGrapes
 {
 
@@ -14,7 +16,19 @@ struct Task;
 
 struct QueueProperty
 {
-    Task * next;
+    //! intrusive link of the EmplacementQueue
+    std::atomic< QueueProperty * > next;
+
+    QueueProperty() : next( nullptr ) {}
+
+    // a copy is not enqueued anywhere
+    QueueProperty( QueueProperty && ) : next( nullptr ) {}
+    QueueProperty( QueueProperty const & ) : next( nullptr ) {}
+
+    QueueProperty & operator=(QueueProperty const &)
+    {
+        return *this;
+    }
 
     template < typename PropertiesBuilder >
     struct Builder
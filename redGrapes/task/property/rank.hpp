@@ -0,0 +1,105 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+ * @file redGrapes/task/property/rank.hpp
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include <fmt/format.h>
+
+namespace redGrapes
+{
+
+struct Task;
+
+/*!
+ * Estimated upward rank of a task, maintained by scheduler::rank
+ * while a CriticalPathScheduler exists. All fields stay zero otherwise.
+ */
+struct RankProperty
+{
+    //! label or callable type whose execution times estimate the cost
+    size_t rank_cost_class;
+
+    //! estimated execution time in nanoseconds
+    uint64_t rank_cost;
+
+    //! cost plus the largest rank of all following tasks
+    std::atomic< uint64_t > upward_rank;
+
+    //! execution time of the slices so far, only touched by the executing worker
+    uint64_t rank_elapsed;
+
+    /*! unfinished tasks which have to finish before this one,
+     *  each holds a removal reference until this task starts.
+     *  Guarded by `rank_mutex`.
+     */
+    std::vector< Task * > rank_preceding;
+    std::mutex rank_mutex;
+
+    RankProperty()
+        : rank_cost_class( 0 )
+        , rank_cost( 0 )
+        , upward_rank( 0 )
+        , rank_elapsed( 0 )
+    {}
+
+    RankProperty( RankProperty const & other )
+        : rank_cost_class( other.rank_cost_class )
+        , rank_cost( other.rank_cost )
+        , upward_rank( other.upward_rank.load( std::memory_order_relaxed ) )
+        , rank_elapsed( 0 )
+    {}
+
+    template < typename PropertiesBuilder >
+    struct Builder
+    {
+        Builder( PropertiesBuilder & ) {}
+    };
+
+    struct Patch
+    {
+        template <typename PatchBuilder>
+        struct Builder
+        {
+            Builder( PatchBuilder & ) {}
+        };
+    };
+
+    void apply_patch( Patch const & ) {};
+};
+
+} // namespace redGrapes
+
+template <>
+struct fmt::formatter< redGrapes::RankProperty >
+{
+    constexpr auto parse( format_parse_context& ctx )
+    {
+        return ctx.begin();
+    }
+
+    template < typename FormatContext >
+    auto format(
+        redGrapes::RankProperty const & rank_prop,
+        FormatContext & ctx
+    )
+    {
+        return format_to(
+                   ctx.out(),
+                   "\"rank\" : {}",
+                   rank_prop.upward_rank.load( std::memory_order_relaxed )
+               );
+    }
+};
+
@@ -0,0 +1,91 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+ * @file redGrapes/task/property/yield.hpp
+ */
+
+#pragma once
+
+#include <fmt/format.h>
+
+namespace redGrapes
+{
+
+/*!
+ * Whether a task gets a stack of its own.
+ *
+ * By default a task runs directly on the stack of the worker which
+ * executes it. If it waits for an event (e.g. Future::get()), the worker
+ * executes other ready tasks on top of it until the event is reached.
+ * Only its own descendants run stackless there, any other task gets a
+ * fiber for that execution, so it can not block the waiting task.
+ *
+ * A task with `may_yield` runs on a separate fiber instead and is paused
+ * while it waits, so its worker is free again. This costs a stack and
+ * a context switch per execution, but is required if the task waits for
+ * something that only progresses after other tasks finished, e.g. an
+ * MPI request of the RequestPool.
+ */
+struct YieldProperty
+{
+    bool may_yield;
+
+    YieldProperty() : may_yield( false ) {}
+
+    template < typename PropertiesBuilder >
+    struct Builder
+    {
+        PropertiesBuilder & builder;
+
+        Builder( PropertiesBuilder & b )
+            : builder(b)
+        {}
+
+        PropertiesBuilder may_yield( bool y = true )
+        {
+            builder.prop.may_yield = y;
+            return builder;
+        }
+    };
+
+    struct Patch
+    {
+        template <typename PatchBuilder>
+        struct Builder
+        {
+            Builder( PatchBuilder & ) {}
+        };
+    };
+
+    void apply_patch( Patch const & ) {};
+};
+
+} // namespace redGrapes
+
+template <>
+struct fmt::formatter< redGrapes::YieldProperty >
+{
+    constexpr auto parse( format_parse_context& ctx )
+    {
+        return ctx.begin();
+    }
+
+    template < typename FormatContext >
+    auto format(
+        redGrapes::YieldProperty const & yield_prop,
+        FormatContext & ctx
+    )
+    {
+        return format_to(
+                   ctx.out(),
+                   "\"may_yield\" : {}",
+                   yield_prop.may_yield
+               );
+    }
+};
+
@@ -0,0 +1,129 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <unordered_map>
+
+#include <redGrapes/resource/resource_user.hpp>
+#include <redGrapes/task/replay.hpp>
+#include <redGrapes/task/task.hpp>
+#include <redGrapes/task/task_space.hpp>
+
+namespace redGrapes
+{
+
+std::shared_ptr< ReplayPlan const > build_replay_plan( std::vector< ResourceUser const * > const & users )
+{
+    auto plan = std::make_shared< ReplayPlan >();
+    plan->nodes.resize( users.size() );
+
+    std::unordered_map< unsigned, unsigned > slot_of;
+
+    // like ResourceUsers::tasks, with holes as -1
+    std::vector< std::vector< int > > frontier;
+
+    for( unsigned i = 0; i < users.size(); ++i )
+    {
+        ResourceUser const & user = *users[ i ];
+        ReplayPlan::Node & node = plan->nodes[ i ];
+        node.covered = true;
+
+        for( ResourceEntry const & r : user.unique_resources )
+        {
+            unsigned id = r.resource.id;
+            auto s = slot_of.emplace( id, frontier.size() );
+            if( s.second )
+                frontier.emplace_back();
+
+            unsigned slot = s.first->second;
+            node.resource_slots.push_back( slot );
+
+            bool covered = false;
+            std::vector< int > & tasks = frontier[ slot ];
+            for( int k = int( tasks.size() ) - 1; k >= 0; --k )
+            {
+                int j = tasks[ k ];
+                if( j < 0 || ! ResourceUser::is_serial( *users[ j ], user ) )
+                    continue;
+
+                node.preceding.push_back( j );
+
+                if( ResourceUser::is_serial( *users[ j ], user, id ) )
+                {
+                    covered = ResourceUser::is_superset( *users[ j ], user, id );
+
+                    if( ResourceUser::is_superset( user, *users[ j ], id ) )
+                    {
+                        node.dominated.emplace_back( j, id );
+                        tasks[ k ] = -1;
+                    }
+
+                    if( covered )
+                        break;
+                }
+            }
+
+            tasks.push_back( i );
+            node.covered = node.covered && covered;
+        }
+
+        std::sort( node.preceding.begin(), node.preceding.end() );
+        node.preceding.erase( std::unique( node.preceding.begin(), node.preceding.end() ), node.preceding.end() );
+    }
+
+    plan->n_slots = frontier.size();
+    return plan;
+}
+
+constexpr uint64_t ReplayInstance::not_inserted;
+
+ReplayInstance::ReplayInstance( std::shared_ptr< ReplayPlan const > plan )
+    : plan( plan )
+    , tasks( plan->nodes.size(), nullptr )
+    , expected( plan->n_slots, not_inserted )
+    , tainted( plan->n_slots, 0 )
+{
+}
+
+bool ReplayInstance::use_plan( unsigned node, std::vector< ResourceEntry > const & resources )
+{
+    ReplayPlan::Node const & n = plan->nodes[ node ];
+    bool valid = n.covered;
+
+    for( unsigned k = 0; k < resources.size(); ++k )
+    {
+        unsigned slot = n.resource_slots[ k ];
+        // the first access of the replay to a resource is never covered
+        if( expected[ slot ] != not_inserted
+            && resources[ k ].resource.users->n_inserted != expected[ slot ] )
+            tainted[ slot ] = 1;
+
+        valid = valid && ! tainted[ slot ];
+    }
+
+    return valid;
+}
+
+void ReplayInstance::inserted( unsigned node, std::vector< ResourceEntry > const & resources )
+{
+    ReplayPlan::Node const & n = plan->nodes[ node ];
+    for( unsigned k = 0; k < resources.size(); ++k )
+        expected[ n.resource_slots[ k ] ] = resources[ k ].resource.users->n_inserted;
+}
+
+void ReplayInstance::initialized()
+{
+    if( ++n_initialized < tasks.size() )
+        return;
+
+    for( Task * task : tasks )
+        task->space->try_remove( *task );
+
+    delete this;
+}
+
+} // namespace redGrapes
@@ -0,0 +1,101 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+ * @file redGrapes/task/replay.hpp
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace redGrapes
+{
+
+struct Task;
+struct ResourceEntry;
+class ResourceUser;
+
+/*!
+ * Dependencies among the tasks of a recorded TaskGraph,
+ * computed once with the same rules as GraphProperty::init_graph.
+ */
+struct ReplayPlan
+{
+    struct Node
+    {
+        //! preceding nodes, ascending
+        std::vector< unsigned > preceding;
+
+        //! (node, resource id) entries this node removes from the task list of the resource
+        std::vector< std::pair< unsigned, unsigned > > dominated;
+
+        //! slot of each resource, in the order of ResourceUser::unique_resources
+        std::vector< unsigned > resource_slots;
+
+        /*! every access of this node is covered by a preceding node,
+         *  so tasks outside of the graph are ordered before it transitively
+         *  and the task lists of its resources need not be searched
+         */
+        bool covered = false;
+    };
+
+    std::vector< Node > nodes;
+
+    //! number of distinct resources
+    unsigned n_slots = 0;
+};
+
+//! @param users resource accesses of the recorded tasks in emplacement order
+std::shared_ptr< ReplayPlan const > build_replay_plan( std::vector< ResourceUser const * > const & users );
+
+/*!
+ * State of one replay of a ReplayPlan.
+ *
+ * Its tasks are initialized in order, so at most one thread
+ * accesses the instance at a time. Each task holds an extra removal
+ * reference, so that the tasks stay alive for the edges of their
+ * successors. All of them are dropped once the last task got
+ * initialized, then the instance deletes itself.
+ */
+struct ReplayInstance
+{
+    std::shared_ptr< ReplayPlan const > plan;
+
+    //! tasks of the nodes initialized so far
+    std::vector< Task * > tasks;
+
+    static constexpr uint64_t not_inserted = uint64_t( -1 );
+
+    /*! ResourceUsers::n_inserted after the last insertion of a task of this instance,
+     *  `not_inserted` before the first one
+     */
+    std::vector< uint64_t > expected;
+
+    //! set once another task got inserted in between, the plan is not valid anymore
+    std::vector< char > tainted;
+
+    unsigned n_initialized = 0;
+
+    ReplayInstance( std::shared_ptr< ReplayPlan const > plan );
+
+    /*! the task lists of the resources have to be locked
+     *  @return true if the dependencies of the node may be taken from the plan
+     */
+    bool use_plan( unsigned node, std::vector< ResourceEntry > const & resources );
+
+    //! the task lists of the resources have to be locked
+    void inserted( unsigned node, std::vector< ResourceEntry > const & resources );
+
+    //! called after the task of the node is initialized, may delete the instance
+    void initialized();
+};
+
+} // namespace redGrapes
@@ -14,6 +14,8 @@
 #include <redGrapes/task/property/resource.hpp>
 #include <redGrapes/task/property/queue.hpp>
 #include <redGrapes/task/property/graph.hpp>
+#include <redGrapes/task/property/yield.hpp>
+#include <redGrapes/task/property/rank.hpp>
 
 namespace redGrapes
 {
@@ -22,7 +24,9 @@ using TaskProperties = TaskProperties1<
     IDProperty,
     ResourceProperty,
     QueueProperty,
-    GraphProperty
+    GraphProperty,
+    YieldProperty,
+    RankProperty
 #ifdef REDGRAPES_TASK_PROPERTIES
     , REDGRAPES_TASK_PROPERTIES
 #endif
@@ -33,14 +37,11 @@ struct Task :
         TaskProperties,
         std::enable_shared_from_this<Task>
 {
-    bool alive;
-
     virtual ~Task()
     {}
 
     Task(TaskProperties && prop)
         : TaskProperties(std::move(prop))
-        , alive(true)
     {}
 
     virtual void * get_result_data()
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <cassert>
 #include <mutex>
 #include <functional>
 #include <vector>
@@ -25,10 +26,27 @@ struct TaskBase : virtual ITask
     bool finished;
 
     virtual ~TaskBase() {}
-    TaskBase() : finished(false) {}
-
-    std::optional< scheduler::EventPtr > operator() ()
+    TaskBase() : finished(false), stackless(false) {}
+
+    /*! run the task until it finishes or yields
+     *
+     * @param may_yield if false and the task was not started yet,
+     *                  run it directly on the stack of the caller
+     *                  instead of a fiber. It can not be paused then.
+     * @return event to wait for if the task yielded, nullopt if it finished
+     */
+    std::optional< scheduler::EventPtr > operator() ( bool may_yield = true )
     {
+        if( ! may_yield && ! resume_cont )
+        {
+            stackless = true;
+            this->run();
+            stackless = false;
+
+            this->event = std::nullopt;
+            return event;
+        }
+
         if(!resume_cont)
             resume_cont = boost::context::callcc(
                 [this](boost::context::continuation&& c)
@@ -56,8 +74,11 @@ struct TaskBase : virtual ITask
         return event;
     }
 
+    //! pause the task until event is reached, only if not running stackless
     void yield( scheduler::EventPtr event )
     {
+        assert( ! stackless );
+
         this->event = event;
 
         std::optional< boost::context::continuation > old_yield;
@@ -73,7 +94,21 @@ struct TaskBase : virtual ITask
 
     std::optional< scheduler::EventPtr > event;
 
+    //! true once the task was executed at least once on a fiber, i.e. it is paused or finished
+    bool is_started() const
+    {
+        return bool(resume_cont);
+    }
+
+    //! true while the task runs on the stack of its worker
+    bool is_stackless() const
+    {
+        return stackless;
+    }
+
 private:
+    bool stackless;
+
     std::mutex yield_cont_mutex;
 
     std::optional< boost::context::continuation > yield_cont;
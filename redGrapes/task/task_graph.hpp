@@ -0,0 +1,204 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+ * @file redGrapes/task/task_graph.hpp
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+#include <redGrapes/context.hpp>
+#include <redGrapes/scheduler/rank.hpp>
+#include <redGrapes/task/replay.hpp>
+#include <redGrapes/task/task.hpp>
+#include <redGrapes/task/task_space.hpp>
+#include <redGrapes/trace/profiler.hpp>
+#include <redGrapes/trace/tracer.hpp>
+
+namespace redGrapes
+{
+
+std::shared_ptr<TaskSpace> current_task_space();
+
+/*!
+ * Tasks emplaced during record(), which can be emplaced again
+ * with the same properties and callables by replay().
+ *
+ * The dependencies among the tasks are computed once when recording,
+ * so replaying a graph skips the search through the task lists of
+ * the resources for all tasks whose accesses are covered by an
+ * earlier task of the same replay.
+ */
+class TaskGraph
+{
+public:
+    //! number of recorded tasks
+    size_t size() const
+    {
+        return data->nodes.size();
+    }
+
+    //! false if a recorded callable could not be copied
+    bool replayable() const
+    {
+        return data->replayable;
+    }
+
+    /*! emplace all recorded tasks into the current task space,
+     *  in the order they were recorded. Results are discarded.
+     */
+    void replay() const
+    {
+        if( ! data->replayable )
+            throw std::runtime_error("TaskGraph: a recorded task has a callable which can not be copied");
+
+        if( data->nodes.empty() )
+            return;
+
+        // deletes itself once all tasks are initialized
+        ReplayInstance * instance = new ReplayInstance( data->plan );
+
+        std::shared_ptr< TaskSpace > space = current_task_space();
+        for( unsigned i = 0; i < data->nodes.size(); ++i )
+        {
+            typename TaskProperties::Builder builder( data->nodes[ i ].prop );
+            builder.prop.replay = instance;
+            builder.prop.replay_index = i;
+
+            builder.init_id();
+            trace::record_create( builder.prop );
+            profiler::record_create( builder.prop, current_task );
+            scheduler::rank::record_create( builder.prop, *data->nodes[ i ].callable_type );
+
+            // each task owns its callable and arguments, since tasks
+            // of overlapping replays may run at the same time
+            std::function< void () > impl = data->nodes[ i ].impl;
+            Task & task = space->emplace_task( std::move( impl ), (TaskProperties &&) builder );
+
+            // nobody waits for the result
+            task.get_result_get_event().notify();
+        }
+    }
+
+    //! the graph which is recorded by this thread, may be null
+    static TaskGraph *& recording()
+    {
+        static thread_local TaskGraph * graph = nullptr;
+        return graph;
+    }
+
+    /*! called by emplace_task() for each task
+     *  while this graph is recording
+     */
+    template < typename F >
+    void capture(
+        F const & impl,
+        TaskProperties const & prop,
+        std::type_info const & callable_type,
+        std::shared_ptr< TaskSpace > const & space )
+    {
+        // children of the recorded tasks are not part of the graph
+        if( space != data->space )
+            return;
+
+        data->nodes.push_back( Node{ prop, copy_impl( impl ), &callable_type } );
+        if( ! data->nodes.back().impl )
+            data->replayable = false;
+    }
+
+    template < typename F >
+    friend TaskGraph record( F && f );
+
+private:
+    struct Node
+    {
+        TaskProperties prop;
+        std::function< void () > impl;
+        std::type_info const * callable_type;
+    };
+
+    struct Data
+    {
+        //! space the graph was recorded in
+        std::shared_ptr< TaskSpace > space;
+
+        std::vector< Node > nodes;
+        bool replayable = true;
+
+        std::shared_ptr< ReplayPlan const > plan;
+    };
+
+    std::shared_ptr< Data > data;
+
+    TaskGraph()
+        : data( std::make_shared< Data >() )
+    {}
+
+    template < typename F >
+    static typename std::enable_if< std::is_copy_constructible< F >::value, std::function< void () > >::type
+    copy_impl( F const & impl )
+    {
+        return impl;
+    }
+
+    template < typename F >
+    static typename std::enable_if< ! std::is_copy_constructible< F >::value, std::function< void () > >::type
+    copy_impl( F const & )
+    {
+        return std::function< void () >();
+    }
+};
+
+/*! run `f` and record the tasks it emplaces into the current task space.
+ *  The tasks are executed as usual, replay() emplaces them again.
+ *
+ * Example:
+ * \code
+ * auto step = redGrapes::record( [&] {
+ *     redGrapes::emplace_task( [] ( auto a ) { ... }, a.write() );
+ *     redGrapes::emplace_task( [] ( auto a, auto b ) { ... }, a.read(), b.write() );
+ * } );
+ *
+ * for( int i = 1; i < n_steps; ++i )
+ *     step.replay();
+ * \endcode
+ */
+template < typename F >
+TaskGraph record( F && f )
+{
+    TaskGraph graph;
+    graph.data->space = current_task_space();
+
+    TaskGraph * outer = TaskGraph::recording();
+    TaskGraph::recording() = &graph;
+    try
+    {
+        f();
+    }
+    catch( ... )
+    {
+        TaskGraph::recording() = outer;
+        throw;
+    }
+    TaskGraph::recording() = outer;
+
+    std::vector< ResourceUser const * > users;
+    for( auto & node : graph.data->nodes )
+        users.push_back( &node.prop );
+    graph.data->plan = build_replay_plan( users );
+
+    return graph;
+}
+
+} // namespace redGrapes
@@ -5,51 +5,90 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 
+#include <redGrapes/task/replay.hpp>
 #include <redGrapes/task/task.hpp>
 #include <redGrapes/task/task_space.hpp>
+#include <redGrapes/trace/counters.hpp>
 
 namespace redGrapes
 {
-    EmplacementQueue::EmplacementQueue() : head(nullptr), tail(nullptr)
+    EmplacementQueue::EmplacementQueue()
+        : head(&stub)
+        , tail(&stub)
     {
     }
 
-    void EmplacementQueue::push(Task* item)
+    void EmplacementQueue::push_node(QueueProperty* node)
     {
-        std::lock_guard<std::mutex> lock(m);
-        item->next = nullptr;
-
-        if(tail)
-            while(!__sync_bool_compare_and_swap(&(tail->next), nullptr, item))
-                ;
-
-        tail = item;
+        node->next.store(nullptr, std::memory_order_relaxed);
+        QueueProperty* prev = head.exchange(node, std::memory_order_acq_rel);
 
-        __sync_bool_compare_and_swap(&head, 0, item);
+        // between the exchange and this store, node is not
+        // reachable from tail yet and pop() reports empty
+        prev->next.store(node, std::memory_order_release);
+    }
 
-        SPDLOG_TRACE("push: head = {}, tail = {}", (void*) head, (void*) tail);
+    void EmplacementQueue::push(Task* item)
+    {
+        push_node(item);
+        SPDLOG_TRACE("queue push: item={}", (void*) item);
     }
 
     Task* EmplacementQueue::pop()
     {
-        std::lock_guard<std::mutex> lock(m);
-        while(Task* t = head)
-            if(__sync_bool_compare_and_swap(&head, t, t->next))
-            {
-                SPDLOG_TRACE("queue pop: item={}, new head = {}", (void*) t, (void*) t->next);
-                return t;
-            }
+        QueueProperty* t = tail;
+        QueueProperty* next = t->next.load(std::memory_order_acquire);
+
+        if(t == &stub)
+        {
+            if(!next)
+                return nullptr;
+
+            // skip the stub
+            tail = next;
+            t = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+
+        if(next)
+        {
+            tail = next;
+            SPDLOG_TRACE("queue pop: item={}", (void*) t);
+            return static_cast<Task*>(t);
+        }
+
+        // t is the last element, unless a push is in progress
+        if(t != head.load(std::memory_order_acquire))
+            return nullptr;
+
+        // put the stub behind t, so t can be unlinked
+        push_node(&stub);
+
+        next = t->next.load(std::memory_order_acquire);
+        if(next)
+        {
+            tail = next;
+            SPDLOG_TRACE("queue pop: item={}", (void*) t);
+            return static_cast<Task*>(t);
+        }
 
-        SPDLOG_TRACE("pop: head = {}, tail = {}", (void*) head, (void*) tail);
         return nullptr;
     }
 
+    bool EmplacementQueue::empty() const
+    {
+        // the tail is the next element to pop, unless it is the stub
+        return tail == &stub && stub.next.load(std::memory_order_acquire) == nullptr;
+    }
+
     TaskSpace::~TaskSpace()
     {
     }
 
     TaskSpace::TaskSpace()
-        : depth(0)
+        : eager_init(default_eager_init())
+        , scheduled(false)
+        , depth(0)
         , parent(nullptr)
         , next_id(0)
     {
@@ -58,10 +97,15 @@ namespace redGrapes
 
     // sub space
     TaskSpace::TaskSpace(Task& parent)
-        : depth(parent.space->depth + 1)
+        : eager_init(parent.space->eager_init)
+        , scheduled(false)
+        , depth(parent.space->depth + 1)
         , parent(&parent)
     {
-        task_count = 0;
+        // the running parent counts as one task,
+        // so the space only runs empty after it finished
+        task_count = 1;
+        ++ parent.removal_refs;
     }
 
     bool TaskSpace::is_serial(Task& a, Task& b)
@@ -92,35 +136,123 @@ namespace redGrapes
 
             next_id++;
             */
-            task->alive = 1;
-            task->pre_event.up();
-            task->init_graph();
-            if(task->get_pre_event().notify())
+            if(init_task(*task))
                 return true;
         }
 
         return false;
     }
 
-    void TaskSpace::try_remove(Task& task)
+    bool TaskSpace::init_task(Task& task)
+    {
+        if( task.batch_next )
+            return init_batch(task);
+
+        task.pre_event.up();
+        task.init_graph();
+        bool ready = task.get_pre_event().notify();
+
+        // the task is kept alive by the replay until here
+        if( task.replay )
+            task.replay->initialized();
+
+        return ready;
+    }
+
+    bool TaskSpace::init_batch(Task& leader)
     {
-        if(task.post_event.is_reached() && task.result_get_event.is_reached() && (!task.children || task.children->empty()))
+        std::vector<Task*> batch;
+        for( Task* task = &leader; task; task = task->batch_next )
         {
-            if( __sync_bool_compare_and_swap(&task.alive, 1, 0) )
-            {
-                task.delete_from_resources();
-                task.~Task();
-                task_storage.m_free(&task);
+            task->pre_event.up();
+            batch.push_back(task);
+        }
 
-                auto ts = top_scheduler;
+        GraphProperty::init_graph_batch(batch);
 
-                --task_count;
+        bool ready = false;
+        for( Task* task : batch )
+            ready = task->get_pre_event().notify() || ready;
 
-                ts->notify();
+        return ready;
+    }
+
+    void TaskSpace::emplace_batch(std::vector<Task*> const & tasks)
+    {
+        for( unsigned k = 0; k < tasks.size(); ++k )
+        {
+            Task* task = tasks[k];
+            task->space = shared_from_this();
+            task->task = task;
+            task->batch_next = ( k + 1 < tasks.size() ) ? tasks[k + 1] : nullptr;
+
+            if( parent )
+            {
+                assert( is_superset(*parent, *task) );
+                task->post_event.add_follower( parent->get_post_event() );
             }
         }
 
-        // todo multiple chunks!
+        task_count += tasks.size();
+        trace::ThreadCounters::add( trace::counters().tasks_created, tasks.size() );
+
+        if( eager_init )
+            init_batch(*tasks[0]);
+        else
+        {
+            queue.push(tasks[0]);
+            if( schedule() )
+                top_scheduler->wake_worker();
+        }
+    }
+
+    bool TaskSpace::schedule()
+    {
+        if( scheduled.exchange(true) )
+            return false;
+
+        active_task_spaces.enqueue(shared_from_this());
+        return true;
+    }
+
+    bool TaskSpace::reschedule()
+    {
+        std::lock_guard<std::mutex> lock(emplacement_mutex);
+        if( ! queue.empty() )
+            return true;
+
+        /* a push which came before clearing the flag saw it still set
+         * and relies on us, the exchange makes that push visible.
+         * Pushes after it enqueue the space themselves.
+         */
+        scheduled.exchange(false);
+        return ! queue.empty() && ! scheduled.exchange(true);
+    }
+
+    void TaskSpace::try_remove(Task& task)
+    {
+        if( task.removal_refs.fetch_sub(1) == 1 )
+        {
+            // the task might hold the last reference to this space
+            auto self = shared_from_this();
+
+            task.delete_from_resources();
+            task.~Task();
+            task_storage.m_free(&task);
+            trace::ThreadCounters::add( trace::counters().tasks_removed );
+
+            dec_task_count();
+        }
+    }
+
+    void TaskSpace::dec_task_count()
+    {
+        auto ts = top_scheduler;
+
+        if( --task_count == 0 && parent )
+            parent->space->try_remove( *parent );
+
+        ts->notify();
     }
 
     bool TaskSpace::empty() const
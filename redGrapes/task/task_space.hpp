@@ -13,21 +13,46 @@
 
 #include <redGrapes/task/allocator.hpp>
 #include <redGrapes/task/task.hpp>
+#include <redGrapes/trace/counters.hpp>
 
 namespace redGrapes
 {
 
+/*!
+ * Intrusive multi-producer single-consumer queue
+ * after Vyukov, linked through QueueProperty::next.
+ *
+ * push() is wait-free and may be called from any thread,
+ * pop() must only be called by one thread at a time.
+ */
 struct EmplacementQueue
-{    
-    Task * head;
-    Task * tail;
+{
+    //! last pushed element, producers exchange themselves in here
+    std::atomic< QueueProperty * > head;
+
+    //! next element to pop, only touched by the consumer
+    QueueProperty * tail;
+
+    //! placeholder to keep the list non-empty
+    QueueProperty stub;
 
-    std::mutex m;
-    
     EmplacementQueue();
-    
+
     void push(Task * task);
+
+    /*! @return oldest task in the queue, or nullptr if empty.
+     *          nullptr is also returned if a concurrent push
+     *          is not yet linked, this push notifies afterwards.
+     */
     Task * pop();
+
+    /*! @return true if pop() has nothing left to return,
+     *          must only be called by the consumer
+     */
+    bool empty() const;
+
+private:
+    void push_node(QueueProperty * node);
 };
 
 /*!
@@ -38,10 +63,48 @@ struct TaskSpace : std::enable_shared_from_this<TaskSpace>
     memory::Allocator task_storage;
     std::atomic< unsigned long > task_count;
 
+    /*! if true, emplace_task() inserts the task into the
+     *  dependency graph right away, instead of leaving that to
+     *  the workers through the emplacement queue
+     */
+    bool const eager_init;
+
+    /*! eager_init of task spaces which get created afterwards,
+     *  can be set before redGrapes::init()
+     */
+    static bool & default_eager_init()
+    {
+        static bool eager = false;
+        return eager;
+    }
+
+    //! sets default_eager_init() while it lives and restores the previous value
+    struct ScopedEagerInit
+    {
+        bool const previous;
+
+        ScopedEagerInit( bool eager = true )
+            : previous( default_eager_init() )
+        {
+            default_eager_init() = eager;
+        }
+
+        ~ScopedEagerInit()
+        {
+            default_eager_init() = previous;
+        }
+    };
+
     /* queue */
+    //! serializes the consumers of the queue
     std::mutex emplacement_mutex;
     EmplacementQueue queue;
 
+    /*! true while this space is in `active_task_spaces`
+     *  (or being initialized from there), so it is enqueued at most once
+     */
+    std::atomic< bool > scheduled;
+
     unsigned depth;
     Task * parent;
 
@@ -72,19 +135,96 @@ struct TaskSpace : std::enable_shared_from_this<TaskSpace>
 
         task->space = shared_from_this();
         task->task = task;
-        task->next = nullptr;
+
+        // the tasks of a replay stay alive until all of them are initialized,
+        // see ReplayInstance::initialized()
+        if( task->replay )
+            ++ task->removal_refs;
 
         ++ task_count;
+        trace::ThreadCounters::add( trace::counters().tasks_created );
 
         if( parent )
+        {
             assert( is_superset(*parent, *task) );
 
-        queue.push(task);
+            // the parent is not finished before all of its children are.
+            // The edge is added here and not in init_graph(), since the
+            // parent is still running now, but possibly no longer
+            // when the task gets initialized.
+            task->post_event.add_follower( parent->get_post_event() );
+        }
+
+        if( eager_init )
+            init_task( *task );
+        else
+        {
+            queue.push(task);
+
+            // some worker has to initialize it, ready tasks
+            // wake further workers through activate_task()
+            if( schedule() )
+                top_scheduler->wake_worker();
+        }
 
-        top_scheduler->notify();
-        
         return *task;
     }    
+
+    /*! create `n` tasks at once: their memory is allocated in one go,
+     *  they are inserted into the dependency graph together and the
+     *  workers are notified once. Tasks of the range which conflict
+     *  are ordered by their index.
+     *
+     * If `make` throws or the memory runs out, no task is emplaced:
+     * the tasks constructed so far are destroyed and all slots freed.
+     *
+     * @param make( k, builder ) sets the properties of the k-th task
+     *        and returns its callable
+     * @return the tasks in order
+     */
+    template < typename F, typename Make >
+    std::vector< Task * > emplace_task_range( size_t n, Make && make )
+    {
+        std::vector< Task * > tasks( n, nullptr );
+        if( n == 0 )
+            return tasks;
+
+        std::vector< void * > mem( n );
+        task_storage.m_alloc( sizeof( FunTask<F> ), n, mem.data() );
+
+        try
+        {
+            for( size_t k = 0; k < n; ++k )
+            {
+                if( ! mem[ k ] )
+                    throw std::runtime_error("out of memory");
+
+                typename TaskProperties::Builder builder;
+                F f = make( k, builder );
+                tasks[ k ] = new ( mem[ k ] ) FunTask<F> ( std::move(f), (TaskProperties &&) builder );
+            }
+        }
+        catch( ... )
+        {
+            // none of the tasks is visible to other threads yet
+            for( size_t k = 0; k < n; ++k )
+            {
+                if( tasks[ k ] )
+                    tasks[ k ]->~Task();
+                if( mem[ k ] )
+                    task_storage.m_free( mem[ k ] );
+            }
+            throw;
+        }
+
+        emplace_batch( tasks );
+        return tasks;
+    }
+
+    /*! add constructed tasks as one batch, see emplace_task_range()
+     *  @param tasks in the order of their creation
+     */
+    void emplace_batch( std::vector< Task * > const & tasks );
     
     /*! take tasks from the emplacement queue and initialize them,
      *  until a task is initialized whose execution could start immediately
@@ -94,8 +234,41 @@ struct TaskSpace : std::enable_shared_from_this<TaskSpace>
      */
     bool init_until_ready();
 
+    /*! insert a task into the dependency graph
+     *  and activate it if it is ready
+     *
+     * @return true if the task is ready
+     */
+    bool init_task( Task & task );
+
+    /*! insert all tasks of the batch `leader` leads
+     *  @return true if any of them is ready
+     */
+    bool init_batch( Task & leader );
+
+    /*! enqueue this space to `active_task_spaces`,
+     *  unless it is already scheduled
+     *  @return true if the space was enqueued
+     */
+    bool schedule();
+
+    /*! called after init_until_ready() for a space taken from
+     *  `active_task_spaces`.
+     *  @return true if tasks are left to initialize, then the space
+     *          is still scheduled and the caller has to enqueue it again
+     */
+    bool reschedule();
+
+    /*! drop one of the references in Task::removal_refs
+     *  and remove the task if it was the last one
+     */
     void try_remove( Task & task );
 
+    /*! a task of this space was removed or the parent finished.
+     *  The last one also drops the reference to the parent.
+     */
+    void dec_task_count();
+
     bool empty() const;
 };
 
@@ -0,0 +1,132 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <redGrapes/dispatch/thread/worker.hpp>
+#include <redGrapes/trace/counters.hpp>
+
+namespace redGrapes
+{
+
+ThreadStats & ThreadStats::operator+= ( ThreadStats const & other )
+{
+    tasks_executed += other.tasks_executed;
+    yields += other.yields;
+    resumes += other.resumes;
+    stackless_waits += other.stackless_waits;
+    idle_ns += other.idle_ns;
+    spin_hits += other.spin_hits;
+    yield_hits += other.yield_hits;
+    parks += other.parks;
+    update_calls += other.update_calls;
+    update_ns += other.update_ns;
+    event_notifications += other.event_notifications;
+    tasks_created += other.tasks_created;
+    tasks_removed += other.tasks_removed;
+    replay_plan_hits += other.replay_plan_hits;
+    replay_plan_misses += other.replay_plan_misses;
+    return *this;
+}
+
+namespace trace
+{
+
+thread_local ThreadCounters * thread_counters = nullptr;
+
+namespace
+{
+
+struct CounterRegistry
+{
+    std::mutex m;
+
+    //! counters outlive their thread, so that the totals stay monotonic
+    std::vector< std::unique_ptr< ThreadCounters > > counters;
+
+    static CounterRegistry & get()
+    {
+        // never destroyed, since threads which exit late
+        // still mark their counters
+        static CounterRegistry * registry = new CounterRegistry();
+        return *registry;
+    }
+};
+
+//! marks the counters of the thread as exited at thread exit
+struct ThreadExitGuard
+{
+    ~ThreadExitGuard()
+    {
+        if( thread_counters )
+            thread_counters->exited = true;
+    }
+};
+
+thread_local ThreadExitGuard thread_exit_guard;
+
+} // namespace
+
+ThreadStats ThreadCounters::snapshot() const
+{
+    ThreadStats s;
+    s.worker_id = worker_id;
+    s.tasks_executed = tasks_executed.load( std::memory_order_relaxed );
+    s.yields = yields.load( std::memory_order_relaxed );
+    s.resumes = resumes.load( std::memory_order_relaxed );
+    s.stackless_waits = stackless_waits.load( std::memory_order_relaxed );
+    s.idle_ns = idle_ns.load( std::memory_order_relaxed );
+    s.spin_hits = spin_hits.load( std::memory_order_relaxed );
+    s.yield_hits = yield_hits.load( std::memory_order_relaxed );
+    s.parks = parks.load( std::memory_order_relaxed );
+    s.update_calls = update_calls.load( std::memory_order_relaxed );
+    s.update_ns = update_ns.load( std::memory_order_relaxed );
+    s.event_notifications = event_notifications.load( std::memory_order_relaxed );
+    s.tasks_created = tasks_created.load( std::memory_order_relaxed );
+    s.tasks_removed = tasks_removed.load( std::memory_order_relaxed );
+    s.replay_plan_hits = replay_plan_hits.load( std::memory_order_relaxed );
+    s.replay_plan_misses = replay_plan_misses.load( std::memory_order_relaxed );
+    return s;
+}
+
+ThreadCounters & register_thread_counters()
+{
+    auto c = std::make_unique< ThreadCounters >();
+    if( auto worker = dispatch::thread::current_worker )
+        c->worker_id = worker->id;
+
+    // instantiate the guard of this thread
+    (void) &thread_exit_guard;
+
+    thread_counters = c.get();
+
+    CounterRegistry & registry = CounterRegistry::get();
+    std::lock_guard< std::mutex > lock( registry.m );
+    registry.counters.push_back( std::move( c ) );
+
+    return *thread_counters;
+}
+
+void collect_thread_stats( std::vector< ThreadStats > & threads, ThreadStats & total )
+{
+    CounterRegistry & registry = CounterRegistry::get();
+    std::lock_guard< std::mutex > lock( registry.m );
+
+    for( auto & c : registry.counters )
+    {
+        ThreadStats s = c->snapshot();
+        total += s;
+
+        if( ! c->exited )
+            threads.push_back( s );
+    }
+}
+
+} // namespace trace
+} // namespace redGrapes
@@ -0,0 +1,153 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+ * @file redGrapes/trace/counters.hpp
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace redGrapes
+{
+
+//! counters of one thread, see stats()
+struct ThreadStats
+{
+    //! index of the worker inside its pool, -1 for other threads
+    int worker_id = -1;
+
+    uint64_t tasks_executed = 0;
+    uint64_t yields = 0;
+    uint64_t resumes = 0;
+
+    //! waits of tasks without may_yield, which blocked their thread
+    uint64_t stackless_waits = 0;
+
+    //! time this worker spent without a task
+    uint64_t idle_ns = 0;
+
+    //! how often the worker found new work in each phase of its IdlePolicy
+    uint64_t spin_hits = 0;
+    uint64_t yield_hits = 0;
+    uint64_t parks = 0;
+
+    uint64_t update_calls = 0;
+    //! time spent in update_active_task_spaces()
+    uint64_t update_ns = 0;
+
+    uint64_t event_notifications = 0;
+
+    uint64_t tasks_created = 0;
+    uint64_t tasks_removed = 0;
+
+    /*! tasks of TaskGraph replays which took their dependencies from the plan,
+     *  and covered ones which had to search since other tasks got in between
+     */
+    uint64_t replay_plan_hits = 0;
+    uint64_t replay_plan_misses = 0;
+
+    ThreadStats & operator+= ( ThreadStats const & other );
+};
+
+/*!
+ * Snapshot of the runtime counters.
+ * All counters are cumulative since the start of the program.
+ */
+struct Stats
+{
+    //! threads which are still running
+    std::vector< ThreadStats > threads;
+
+    //! sum over all threads, including the ones which exited already
+    ThreadStats total;
+
+    //! approximate number of tasks in the ready queue(s) of the scheduler
+    size_t ready_queue_depth = 0;
+
+    //! tasks which are emplaced and not yet removed, in all task spaces
+    int64_t live_tasks = 0;
+
+    /*! task_count of the top-level task space only.
+     *  Child spaces are not listed, since there is no registry of
+     *  them and keeping one would cost a lock per space on the
+     *  emplacement path. Their tasks are counted in live_tasks.
+     */
+    unsigned long top_space_tasks = 0;
+
+    //! chunks of the task allocator which are not returned to a pool
+    int64_t allocator_chunks = 0;
+};
+
+namespace trace
+{
+
+/*!
+ * The counters behind ThreadStats.
+ * Only the owning thread writes them, so an increment is a plain
+ * relaxed load and store. Readers aggregate them lazily in stats().
+ */
+struct ThreadCounters
+{
+    int worker_id = -1;
+
+    //! set when the thread exited
+    std::atomic< bool > exited{ false };
+
+    std::atomic< uint64_t > tasks_executed{ 0 };
+    std::atomic< uint64_t > yields{ 0 };
+    std::atomic< uint64_t > resumes{ 0 };
+    std::atomic< uint64_t > stackless_waits{ 0 };
+    std::atomic< uint64_t > idle_ns{ 0 };
+    std::atomic< uint64_t > spin_hits{ 0 };
+    std::atomic< uint64_t > yield_hits{ 0 };
+    std::atomic< uint64_t > parks{ 0 };
+    std::atomic< uint64_t > update_calls{ 0 };
+    std::atomic< uint64_t > update_ns{ 0 };
+    std::atomic< uint64_t > event_notifications{ 0 };
+    std::atomic< uint64_t > tasks_created{ 0 };
+    std::atomic< uint64_t > tasks_removed{ 0 };
+    std::atomic< uint64_t > replay_plan_hits{ 0 };
+    std::atomic< uint64_t > replay_plan_misses{ 0 };
+
+    static void add( std::atomic< uint64_t > & counter, uint64_t n = 1 )
+    {
+        counter.store( counter.load( std::memory_order_relaxed ) + n, std::memory_order_relaxed );
+    }
+
+    ThreadStats snapshot() const;
+};
+
+//! null until the current thread touched its counters for the first time
+extern thread_local ThreadCounters * thread_counters;
+
+ThreadCounters & register_thread_counters();
+
+//! counters of the current thread
+inline ThreadCounters & counters()
+{
+    if( ! thread_counters )
+        return register_thread_counters();
+    return *thread_counters;
+}
+
+//! clock for the time counters
+inline uint64_t now_ns()
+{
+    return std::chrono::duration_cast< std::chrono::nanoseconds >(
+        std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+//! @return the counters of all threads and their sum
+void collect_thread_stats( std::vector< ThreadStats > & threads, ThreadStats & total );
+
+} // namespace trace
+} // namespace redGrapes
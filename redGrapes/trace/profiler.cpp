@@ -0,0 +1,275 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include <redGrapes/trace/profiler.hpp>
+
+namespace redGrapes
+{
+namespace profiler
+{
+
+std::atomic< bool > is_enabled( false );
+
+namespace
+{
+
+struct TaskRecord
+{
+    TaskID task_id;
+    TaskID parent_id;
+    trace::LabelID label;
+};
+
+//! graph fragments recorded by one thread, only written by that thread
+struct ThreadLog
+{
+    std::vector< TaskRecord > tasks;
+    std::vector< std::pair< TaskID, TaskID > > edges;
+    std::vector< std::pair< TaskID, uint64_t > > executions;
+};
+
+struct Profiler
+{
+    std::mutex m;
+    size_t top_n = 0;
+    Report last_report;
+
+    //! incremented by enable() and disable(), so threads drop stale logs
+    std::atomic< unsigned > generation{ 0 };
+
+    std::vector< std::shared_ptr< ThreadLog > > logs;
+
+    static Profiler & get()
+    {
+        static Profiler * profiler = new Profiler();
+        return *profiler;
+    }
+};
+
+thread_local std::shared_ptr< ThreadLog > thread_log;
+thread_local unsigned thread_generation = 0;
+
+ThreadLog & get_thread_log()
+{
+    Profiler & profiler = Profiler::get();
+
+    if( ! thread_log || thread_generation != profiler.generation )
+    {
+        std::lock_guard< std::mutex > lock( profiler.m );
+
+        thread_log = std::make_shared< ThreadLog >();
+        profiler.logs.push_back( thread_log );
+        thread_generation = profiler.generation;
+    }
+
+    return *thread_log;
+}
+
+struct Node
+{
+    TaskID task_id;
+    std::string label;
+    uint64_t duration = 0;
+
+    std::vector< size_t > followers;
+    unsigned n_preceding = 0;
+
+    //! end of the longest path which ends with this task
+    uint64_t finish = 0;
+
+    //! predecessor on that path
+    size_t critical_pred = size_t( -1 );
+};
+
+} // namespace
+
+void enable( size_t top_n )
+{
+    Profiler & profiler = Profiler::get();
+    std::lock_guard< std::mutex > lock( profiler.m );
+
+    profiler.top_n = top_n;
+    profiler.generation++;
+    profiler.logs.clear();
+
+    is_enabled = true;
+}
+
+void disable()
+{
+    is_enabled = false;
+
+    Profiler & profiler = Profiler::get();
+    std::lock_guard< std::mutex > lock( profiler.m );
+    profiler.generation++;
+    profiler.logs.clear();
+}
+
+void record_task_slow( TaskID task_id, TaskID parent_id, trace::LabelID label )
+{
+    get_thread_log().tasks.push_back( TaskRecord{ task_id, parent_id, label } );
+}
+
+void record_dependency_slow( TaskID preceding_id, TaskID task_id )
+{
+    get_thread_log().edges.emplace_back( preceding_id, task_id );
+}
+
+void record_execution_slow( TaskID task_id, uint64_t duration_ns )
+{
+    get_thread_log().executions.emplace_back( task_id, duration_ns );
+}
+
+Report analyze()
+{
+    Profiler & profiler = Profiler::get();
+    std::lock_guard< std::mutex > lock( profiler.m );
+
+    std::vector< Node > nodes;
+    std::unordered_map< TaskID, size_t > index;
+
+    auto node = [&]( TaskID id ) -> size_t
+    {
+        auto it = index.find( id );
+        if( it != index.end() )
+            return it->second;
+
+        index.emplace( id, nodes.size() );
+        nodes.emplace_back();
+        nodes.back().task_id = id;
+        return nodes.size() - 1;
+    };
+
+    auto add_edge = [&]( TaskID from, TaskID to )
+    {
+        size_t a = node( from );
+        size_t b = node( to );
+        nodes[ a ].followers.push_back( b );
+        nodes[ b ].n_preceding++;
+    };
+
+    for( auto & log : profiler.logs )
+        for( TaskRecord const & t : log->tasks )
+        {
+            nodes[ node( t.task_id ) ].label = trace::label_name( t.label );
+            if( t.parent_id != TaskID( -1 ) )
+                add_edge( t.parent_id, t.task_id );
+        }
+
+    for( auto & log : profiler.logs )
+    {
+        for( auto const & e : log->edges )
+            add_edge( e.first, e.second );
+
+        for( auto const & e : log->executions )
+            nodes[ node( e.first ) ].duration += e.second;
+    }
+
+    // longest path in topological order. Task ids are not necessarily
+    // a topological order, since ids are assigned before emplacement.
+    Report report;
+    report.n_tasks = nodes.size();
+
+    std::vector< size_t > ready;
+    for( size_t i = 0; i < nodes.size(); ++i )
+        if( nodes[ i ].n_preceding == 0 )
+            ready.push_back( i );
+
+    size_t last = size_t( -1 );
+    while( ! ready.empty() )
+    {
+        size_t i = ready.back();
+        ready.pop_back();
+
+        Node & n = nodes[ i ];
+        n.finish += n.duration;
+        report.work_ns += n.duration;
+
+        if( last == size_t( -1 ) || n.finish > nodes[ last ].finish )
+            last = i;
+
+        for( size_t f : n.followers )
+        {
+            if( nodes[ f ].critical_pred == size_t( -1 ) || n.finish > nodes[ f ].finish )
+            {
+                nodes[ f ].finish = n.finish;
+                nodes[ f ].critical_pred = i;
+            }
+
+            if( --nodes[ f ].n_preceding == 0 )
+                ready.push_back( f );
+        }
+    }
+
+    if( last != size_t( -1 ) )
+    {
+        report.span_ns = nodes[ last ].finish;
+
+        for( size_t i = last; i != size_t( -1 ); i = nodes[ i ].critical_pred )
+            report.critical_path.push_back(
+                TaskSummary{ nodes[ i ].task_id, nodes[ i ].label, nodes[ i ].duration } );
+
+        std::stable_sort(
+            report.critical_path.begin(), report.critical_path.end(),
+            []( TaskSummary const & a, TaskSummary const & b ) { return a.duration_ns > b.duration_ns; } );
+
+        if( report.critical_path.size() > profiler.top_n )
+            report.critical_path.resize( profiler.top_n );
+    }
+
+    if( report.span_ns > 0 )
+        report.parallelism = double( report.work_ns ) / double( report.span_ns );
+
+    return report;
+}
+
+Report last_report()
+{
+    Profiler & profiler = Profiler::get();
+    std::lock_guard< std::mutex > lock( profiler.m );
+    return profiler.last_report;
+}
+
+void dump()
+{
+    if( ! enabled() )
+        return;
+
+    Report report = analyze();
+
+    spdlog::info(
+        "redGrapes::profiler: {} tasks, work = {:.3f} ms, span = {:.3f} ms, parallelism = {:.2f}",
+        report.n_tasks,
+        report.work_ns / 1e6,
+        report.span_ns / 1e6,
+        report.parallelism );
+
+    for( TaskSummary const & t : report.critical_path )
+        spdlog::info(
+            "redGrapes::profiler: critical path: {:.3f} ms task {}{}",
+            t.duration_ns / 1e6,
+            t.task_id,
+            t.label.empty() ? "" : " " + t.label );
+
+    disable();
+
+    Profiler & profiler = Profiler::get();
+    std::lock_guard< std::mutex > lock( profiler.m );
+    profiler.last_report = std::move( report );
+}
+
+} // namespace profiler
+} // namespace redGrapes
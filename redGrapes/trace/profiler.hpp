@@ -0,0 +1,135 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+ * @file redGrapes/trace/profiler.hpp
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <redGrapes/task/property/id.hpp>
+#include <redGrapes/trace/tracer.hpp>
+
+namespace redGrapes
+{
+namespace profiler
+{
+
+struct TaskSummary
+{
+    TaskID task_id;
+    std::string label;
+
+    //! time spent executing the task, excluding the time it was paused
+    uint64_t duration_ns;
+};
+
+/*!
+ * Analysis of the realized task graph.
+ *
+ * Each task is weighted with its execution time. Edges are the
+ * dependencies found by GraphProperty::add_dependency and the edge from
+ * a parent to each of its children. The latter assumes that the whole
+ * parent precedes the child, so the span is an upper bound for tasks
+ * which do a lot of work before emplacing children.
+ */
+struct Report
+{
+    size_t n_tasks = 0;
+
+    //! sum of all task durations
+    uint64_t work_ns = 0;
+
+    //! length of the longest path (critical path)
+    uint64_t span_ns = 0;
+
+    //! work / span, the maximal speedup any number of workers can achieve
+    double parallelism = 0.0;
+
+    //! longest tasks on the critical path, in descending duration
+    std::vector< TaskSummary > critical_path;
+};
+
+//! only read on the fast path, see enable()
+extern std::atomic< bool > is_enabled;
+
+/*!
+ * Start recording the task graph, must be called before init().
+ * At finalize() the graph gets analyzed, the report is logged
+ * and recording stops.
+ *
+ * @param top_n number of critical-path tasks to report
+ */
+void enable( size_t top_n = 10 );
+
+//! stop recording and drop the recorded graph
+void disable();
+
+inline bool enabled()
+{
+    return is_enabled.load( std::memory_order_relaxed );
+}
+
+inline uint64_t now()
+{
+    return std::chrono::duration_cast< std::chrono::nanoseconds >(
+        std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+void record_task_slow( TaskID task_id, TaskID parent_id, trace::LabelID label );
+void record_dependency_slow( TaskID preceding_id, TaskID task_id );
+void record_execution_slow( TaskID task_id, uint64_t duration_ns );
+
+/*! record a new task and its parent,
+ *  including its label if the task has a LabelProperty
+ */
+template < typename T, typename Parent >
+inline void record_create( T const & task, Parent const * parent )
+{
+    if( enabled() )
+        record_task_slow(
+            task.task_id,
+            parent ? parent->task_id : TaskID( -1 ),
+            trace::detail::task_label( task, 0 ) );
+}
+
+//! record an edge of the precedence graph
+inline void record_dependency( TaskID preceding_id, TaskID task_id )
+{
+    if( enabled() )
+        record_dependency_slow( preceding_id, task_id );
+}
+
+//! record one slice of execution, which began at `begin` (see now())
+inline void record_execution( TaskID task_id, uint64_t begin )
+{
+    if( enabled() )
+        record_execution_slow( task_id, now() - begin );
+}
+
+/*! analyze everything recorded so far.
+ *  No thread may record concurrently.
+ */
+Report analyze();
+
+//! @return report of the last finalize() with an enabled profiler
+Report last_report();
+
+/*! analyze and log the report, then stop recording.
+ *  Does nothing if the profiler is not enabled.
+ *  No thread may record concurrently.
+ */
+void dump();
+
+} // namespace profiler
+} // namespace redGrapes
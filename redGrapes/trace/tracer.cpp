@@ -0,0 +1,319 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include <redGrapes/dispatch/thread/worker.hpp>
+#include <redGrapes/trace/tracer.hpp>
+
+namespace redGrapes
+{
+namespace trace
+{
+
+std::atomic< bool > is_enabled( false );
+
+namespace
+{
+
+//! events of one thread, only written by that thread
+struct ThreadBuffer
+{
+    std::string thread_name;
+    std::vector< Record > ring;
+
+    //! total number of recorded events, the newest is at (count - 1) % size
+    uint64_t count = 0;
+};
+
+struct Tracer
+{
+    std::mutex m;
+    std::string path;
+    size_t capacity = 0;
+    std::chrono::steady_clock::time_point start;
+
+    //! incremented by enable() and disable(), so threads drop stale buffers
+    std::atomic< unsigned > generation{ 0 };
+
+    std::vector< std::shared_ptr< ThreadBuffer > > buffers;
+
+    static Tracer & get()
+    {
+        static Tracer * tracer = new Tracer();
+        return *tracer;
+    }
+};
+
+//! interned labels, never cleared so that ids stay valid
+struct LabelTable
+{
+    std::mutex m;
+    std::unordered_map< std::string, LabelID > ids;
+    std::vector< std::string > names;
+
+    static LabelTable & get()
+    {
+        static LabelTable * table = new LabelTable();
+        return *table;
+    }
+};
+
+thread_local std::unordered_map< std::string, LabelID > label_cache;
+
+thread_local std::shared_ptr< ThreadBuffer > thread_buffer;
+thread_local unsigned thread_generation = 0;
+
+ThreadBuffer & get_thread_buffer()
+{
+    Tracer & tracer = Tracer::get();
+
+    if( ! thread_buffer || thread_generation != tracer.generation )
+    {
+        std::lock_guard< std::mutex > lock( tracer.m );
+
+        thread_buffer = std::make_shared< ThreadBuffer >();
+        thread_buffer->ring.resize( tracer.capacity );
+        if( auto worker = dispatch::thread::current_worker )
+            thread_buffer->thread_name = fmt::format( "worker {}", worker->id );
+        else
+            thread_buffer->thread_name = fmt::format( "thread {}", tracer.buffers.size() );
+
+        tracer.buffers.push_back( thread_buffer );
+        thread_generation = tracer.generation;
+    }
+
+    return *thread_buffer;
+}
+
+char const * kind_name( EventKind kind )
+{
+    switch( kind )
+    {
+    case EventKind::CREATE: return "create";
+    case EventKind::READY: return "ready";
+    case EventKind::START: return "start";
+    case EventKind::YIELD: return "yield";
+    case EventKind::RESUME: return "resume";
+    case EventKind::FINISH: return "finish";
+    }
+    return "";
+}
+
+std::string json_escape( std::string const & s )
+{
+    std::string out;
+    out.reserve( s.size() );
+    for( char c : s )
+        switch( c )
+        {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if( (unsigned char)c < 0x20 )
+                out += fmt::format( "\\u{:04x}", (unsigned)c );
+            else
+                out += c;
+        }
+    return out;
+}
+
+} // namespace
+
+void enable( std::string const & path, size_t capacity )
+{
+    Tracer & tracer = Tracer::get();
+    std::lock_guard< std::mutex > lock( tracer.m );
+
+    tracer.path = path;
+    tracer.capacity = std::max( capacity, size_t(1) );
+    tracer.start = std::chrono::steady_clock::now();
+    tracer.generation++;
+    tracer.buffers.clear();
+
+    is_enabled = true;
+}
+
+void disable()
+{
+    is_enabled = false;
+
+    Tracer & tracer = Tracer::get();
+    std::lock_guard< std::mutex > lock( tracer.m );
+    tracer.generation++;
+    tracer.buffers.clear();
+}
+
+LabelID intern_label( std::string const & label )
+{
+    auto it = label_cache.find( label );
+    if( it != label_cache.end() )
+        return it->second;
+
+    LabelTable & table = LabelTable::get();
+    std::lock_guard< std::mutex > lock( table.m );
+
+    auto ins = table.ids.emplace( label, LabelID( table.names.size() + 1 ) );
+    if( ins.second )
+        table.names.push_back( label );
+
+    label_cache.emplace( label, ins.first->second );
+    return ins.first->second;
+}
+
+std::string label_name( LabelID id )
+{
+    if( id == 0 )
+        return std::string();
+
+    LabelTable & table = LabelTable::get();
+    std::lock_guard< std::mutex > lock( table.m );
+
+    if( id > table.names.size() )
+        return std::string();
+    return table.names[ id - 1 ];
+}
+
+void record_slow( EventKind kind, TaskID task_id, LabelID label )
+{
+    ThreadBuffer & buf = get_thread_buffer();
+
+    Record & r = buf.ring[ buf.count % buf.ring.size() ];
+    r.timestamp = std::chrono::duration_cast< std::chrono::nanoseconds >(
+        std::chrono::steady_clock::now() - Tracer::get().start ).count();
+    r.task_id = task_id;
+    r.kind = kind;
+    r.label = label;
+
+    buf.count++;
+}
+
+void write_chrome_trace( std::ostream & out )
+{
+    Tracer & tracer = Tracer::get();
+    std::lock_guard< std::mutex > lock( tracer.m );
+
+    // labels are recorded once by the thread which created the task
+    std::unordered_map< TaskID, std::string > labels;
+    for( auto & buf : tracer.buffers )
+        for( uint64_t i = buf->count - std::min( buf->count, (uint64_t)buf->ring.size() ); i < buf->count; ++i )
+        {
+            Record const & r = buf->ring[ i % buf->ring.size() ];
+            if( r.kind == EventKind::CREATE && r.label != 0 )
+                labels[ r.task_id ] = label_name( r.label );
+        }
+
+    auto task_name = [&labels]( TaskID id )
+    {
+        auto it = labels.find( id );
+        if( it != labels.end() )
+            return json_escape( it->second );
+        else
+            return fmt::format( "task {}", id );
+    };
+
+    bool first = true;
+    auto separator = [&first]
+    {
+        char const * s = first ? "\n" : ",\n";
+        first = false;
+        return s;
+    };
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    for( size_t tid = 0; tid < tracer.buffers.size(); ++tid )
+    {
+        ThreadBuffer const & buf = *tracer.buffers[ tid ];
+
+        out << separator()
+            << fmt::format( "{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}",
+                            tid, json_escape( buf.thread_name ) );
+
+        /* begins of the currently running slices of execution,
+         * nested if a waiting task executes other tasks on its stack
+         */
+        std::vector< Record const * > slices;
+
+        for( uint64_t i = buf.count - std::min( buf.count, (uint64_t)buf.ring.size() ); i < buf.count; ++i )
+        {
+            Record const & r = buf.ring[ i % buf.ring.size() ];
+            double ts = r.timestamp / 1000.0;
+
+            switch( r.kind )
+            {
+            case EventKind::START:
+            case EventKind::RESUME:
+                slices.push_back( &r );
+                break;
+
+            case EventKind::YIELD:
+            case EventKind::FINISH:
+                // the begin might have been overwritten already
+                if( ! slices.empty() && slices.back()->task_id == r.task_id )
+                {
+                    Record const * slice_begin = slices.back();
+                    slices.pop_back();
+
+                    out << separator()
+                        << fmt::format( "{{\"name\":\"{}\",\"ph\":\"X\",\"ts\":{:.3f},\"dur\":{:.3f},\"pid\":0,\"tid\":{},"
+                                        "\"args\":{{\"task_id\":{},\"begin\":\"{}\",\"end\":\"{}\"}}}}",
+                                        task_name( r.task_id ), slice_begin->timestamp / 1000.0,
+                                        ( r.timestamp - slice_begin->timestamp ) / 1000.0, tid,
+                                        r.task_id, kind_name( slice_begin->kind ), kind_name( r.kind ) );
+                }
+                break;
+
+            case EventKind::CREATE:
+            case EventKind::READY:
+                out << separator()
+                    << fmt::format( "{{\"name\":\"{} {}\",\"ph\":\"i\",\"s\":\"t\",\"ts\":{:.3f},\"pid\":0,\"tid\":{},"
+                                    "\"args\":{{\"task_id\":{}}}}}",
+                                    kind_name( r.kind ), task_name( r.task_id ), ts, tid, r.task_id );
+                break;
+            }
+        }
+    }
+
+    out << "\n]}\n";
+}
+
+void dump()
+{
+    if( ! enabled() )
+        return;
+
+    std::string path;
+    {
+        Tracer & tracer = Tracer::get();
+        std::lock_guard< std::mutex > lock( tracer.m );
+        path = tracer.path;
+    }
+
+    std::ofstream out( path );
+    if( out )
+        write_chrome_trace( out );
+    else
+        spdlog::error( "redGrapes::trace: could not open {}", path );
+
+    disable();
+}
+
+} // namespace trace
+} // namespace redGrapes
+
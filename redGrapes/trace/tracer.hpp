@@ -0,0 +1,127 @@
+/* Copyright 2022 Michael Sippel
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+ * @file redGrapes/trace/tracer.hpp
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include <redGrapes/task/property/id.hpp>
+
+namespace redGrapes
+{
+namespace trace
+{
+
+enum class EventKind : uint8_t
+{
+    CREATE,
+    READY,
+    START,
+    YIELD,
+    RESUME,
+    FINISH
+};
+
+//! id of an interned task label, 0 for none
+using LabelID = uint32_t;
+
+struct Record
+{
+    //! nanoseconds since the tracer got enabled
+    uint64_t timestamp;
+    TaskID task_id;
+    EventKind kind;
+
+    //! only set for CREATE
+    LabelID label;
+};
+
+//! only read on the fast path, see enable()
+extern std::atomic< bool > is_enabled;
+
+/*!
+ * Start recording task events.
+ *
+ * Each thread writes into a ring buffer of its own, which keeps
+ * the last `capacity` events. At finalize() all buffers are written
+ * to `path` in the Chrome trace event format (which is also
+ * understood by Perfetto) and recording stops.
+ */
+void enable( std::string const & path, size_t capacity = 1 << 16 );
+
+//! stop recording and drop all recorded events
+void disable();
+
+inline bool enabled()
+{
+    return is_enabled.load( std::memory_order_relaxed );
+}
+
+void record_slow( EventKind kind, TaskID task_id, LabelID label = 0 );
+
+/*! id of a label, equal labels get the same id.
+ *  Each thread caches the ids it has seen, so this only
+ *  locks the first time a thread sees a label.
+ */
+LabelID intern_label( std::string const & label );
+
+//! the label of an id returned by intern_label()
+std::string label_name( LabelID id );
+
+//! record an event of a task in the buffer of the current thread
+inline void record( EventKind kind, TaskID task_id )
+{
+    if( enabled() )
+        record_slow( kind, task_id );
+}
+
+namespace detail
+{
+template < typename T >
+auto task_label( T const & task, int ) -> decltype( intern_label( task.label ) )
+{
+    return task.label.empty() ? 0 : intern_label( task.label );
+}
+
+template < typename T >
+LabelID task_label( T const &, long )
+{
+    return 0;
+}
+} // namespace detail
+
+/*! record the creation of a task,
+ *  including its label if the task has a LabelProperty
+ */
+template < typename T >
+inline void record_create( T const & task )
+{
+    if( enabled() )
+        record_slow( EventKind::CREATE, task.task_id, detail::task_label( task, 0 ) );
+}
+
+/*! write all recorded events as Chrome trace JSON.
+ *  No thread may record events concurrently.
+ */
+void write_chrome_trace( std::ostream & out );
+
+/*! write the trace to the path given to enable() and stop recording,
+ *  does nothing if the tracer is not enabled.
+ *  No thread may record events concurrently.
+ */
+void dump();
+
+} // namespace trace
+} // namespace redGrapes
+
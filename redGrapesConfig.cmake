@@ -12,11 +12,17 @@ find_package(spdlog REQUIRED)
 add_library(redGrapes
   ${CMAKE_CURRENT_LIST_DIR}/redGrapes/resource/resource.cpp
   ${CMAKE_CURRENT_LIST_DIR}/redGrapes/dispatch/thread/execute.cpp
+  ${CMAKE_CURRENT_LIST_DIR}/redGrapes/dispatch/thread/topology.cpp
   ${CMAKE_CURRENT_LIST_DIR}/redGrapes/scheduler/event.cpp
   ${CMAKE_CURRENT_LIST_DIR}/redGrapes/scheduler/event_ptr.cpp
+  ${CMAKE_CURRENT_LIST_DIR}/redGrapes/scheduler/rank.cpp
   ${CMAKE_CURRENT_LIST_DIR}/redGrapes/task/property/graph.cpp
   ${CMAKE_CURRENT_LIST_DIR}/redGrapes/task/allocator.cpp
+  ${CMAKE_CURRENT_LIST_DIR}/redGrapes/task/replay.cpp
   ${CMAKE_CURRENT_LIST_DIR}/redGrapes/task/task_space.cpp
+  ${CMAKE_CURRENT_LIST_DIR}/redGrapes/trace/counters.cpp
+  ${CMAKE_CURRENT_LIST_DIR}/redGrapes/trace/profiler.cpp
+  ${CMAKE_CURRENT_LIST_DIR}/redGrapes/trace/tracer.cpp
   ${CMAKE_CURRENT_LIST_DIR}/redGrapes/redGrapes.cpp
 )
 
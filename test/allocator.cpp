@@ -0,0 +1,103 @@
+#include <catch/catch.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <redGrapes/task/allocator.hpp>
+
+namespace mem = redGrapes::memory;
+
+TEST_CASE("Allocator")
+{
+    mem::Allocator alloc( 0x4000 );
+    REQUIRE( alloc.chunk_size == 0x4000 );
+
+    std::vector< void * > ptrs;
+    for( size_t n : { 1, 64, 65, 200, 1000, 1500 } )
+    {
+        void * ptr = alloc.m_alloc( n );
+        REQUIRE( ptr != nullptr );
+        REQUIRE( (uintptr_t)ptr % mem::slot_alignment == 0 );
+
+        mem::Chunk * chunk = alloc.chunk_of( ptr );
+        REQUIRE( chunk->contains( ptr ) );
+        REQUIRE( chunk->slot_size >= n );
+        ptrs.push_back( ptr );
+    }
+
+    // freed slots are reused
+    void * p = alloc.m_alloc( 100 );
+    alloc.m_free( p );
+    REQUIRE( alloc.m_alloc( 100 ) == p );
+    alloc.m_free( p );
+
+    // larger than a chunk
+    void * large = alloc.m_alloc( 0x10000 );
+    REQUIRE( alloc.chunk_of( large )->owner_thread == 0 );
+    alloc.m_free( large );
+
+    for( void * ptr : ptrs )
+        alloc.m_free( ptr );
+}
+
+TEST_CASE("Allocator remote free")
+{
+    mem::Allocator alloc( 0x2000 );
+
+    void * ptr = alloc.m_alloc( 64 );
+    REQUIRE( alloc.chunk_of( ptr )->owner_thread == mem::current_thread_index() );
+
+    // a slot freed by another thread is handed back to the owner
+    std::thread( [&]{ alloc.m_free( ptr ); } ).join();
+    REQUIRE( alloc.m_alloc( 64 ) == ptr );
+
+    // each thread allocates from its own chunk
+    void * other;
+    std::thread( [&]{ other = alloc.m_alloc( 64 ); } ).join();
+    REQUIRE( alloc.chunk_of( other ) != alloc.chunk_of( ptr ) );
+
+    alloc.m_free( other );
+    alloc.m_free( ptr );
+}
+
+TEST_CASE("Allocator concurrent free")
+{
+    mem::Allocator alloc( 0x1000 );
+
+    unsigned n_threads = 4;
+    unsigned n_items = 10000;
+    std::vector< std::atomic< void * > > items( n_threads * n_items );
+    for( auto & item : items )
+        item = nullptr;
+
+    std::atomic< bool > ok( true );
+    std::vector< std::thread > threads;
+    for( unsigned t = 0; t < n_threads; ++t )
+        threads.emplace_back(
+            [&, t]
+            {
+                // allocate own items and free those of the previous thread
+                for( unsigned i = 0; i < n_items; ++i )
+                {
+                    void * ptr = alloc.m_alloc( 64 + 64 * ( i % 4 ) );
+                    *(unsigned*)ptr = t;
+                    items[ t * n_items + i ] = ptr;
+
+                    unsigned other = ( ( t + n_threads - 1 ) % n_threads ) * n_items + i;
+                    while( ! items[ other ].load() )
+                        std::this_thread::yield();
+                    if( *(unsigned*)items[ other ].load() != ( t + n_threads - 1 ) % n_threads )
+                        ok = false;
+                }
+            });
+
+    for( auto & t : threads )
+        t.join();
+
+    REQUIRE( ok );
+
+    for( auto & item : items )
+        alloc.m_free( item.load() );
+}
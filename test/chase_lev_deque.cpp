@@ -0,0 +1,93 @@
+#include <catch/catch.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <redGrapes/scheduler/chase_lev_deque.hpp>
+
+TEST_CASE("ChaseLevDeque")
+{
+    redGrapes::scheduler::ChaseLevDeque< int > deque( 4 );
+    int x;
+
+    REQUIRE( deque.empty() );
+    REQUIRE( deque.pop( x ) == false );
+    REQUIRE( deque.steal( x ) == false );
+
+    // grows beyond initial capacity
+    for( int i = 0; i < 10; ++i )
+        deque.push( i );
+
+    REQUIRE( deque.size() == 10 );
+
+    // owner pops LIFO
+    REQUIRE( deque.pop( x ) );
+    REQUIRE( x == 9 );
+
+    // thieves steal FIFO
+    REQUIRE( deque.steal( x ) );
+    REQUIRE( x == 0 );
+    REQUIRE( deque.steal( x ) );
+    REQUIRE( x == 1 );
+
+    for( int i = 8; i >= 2; --i )
+    {
+        REQUIRE( deque.pop( x ) );
+        REQUIRE( x == i );
+    }
+
+    REQUIRE( deque.empty() );
+    REQUIRE( deque.pop( x ) == false );
+}
+
+TEST_CASE("ChaseLevDeque concurrent steal")
+{
+    redGrapes::scheduler::ChaseLevDeque< int > deque;
+
+    int const n_items = 100000;
+    int const n_thieves = 3;
+
+    std::atomic< long > sum( 0 );
+    std::atomic< int > count( 0 );
+    std::atomic_bool done( false );
+
+    std::vector< std::thread > thieves;
+    for( int t = 0; t < n_thieves; ++t )
+        thieves.emplace_back(
+            [&]
+            {
+                int x;
+                while( ! done || ! deque.empty() )
+                    if( deque.steal( x ) )
+                    {
+                        sum += x;
+                        ++count;
+                    }
+            });
+
+    int x;
+    for( int i = 1; i <= n_items; ++i )
+    {
+        deque.push( i );
+        if( i % 3 == 0 && deque.pop( x ) )
+        {
+            sum += x;
+            ++count;
+        }
+    }
+
+    while( deque.pop( x ) )
+    {
+        sum += x;
+        ++count;
+    }
+
+    done = true;
+    for( auto & t : thieves )
+        t.join();
+
+    REQUIRE( count == n_items );
+    REQUIRE( sum == (long) n_items * ( n_items + 1 ) / 2 );
+}
+
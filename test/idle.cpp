@@ -0,0 +1,188 @@
+#include <catch/catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <redGrapes/redGrapes.hpp>
+#include <redGrapes/resource/ioresource.hpp>
+#include <redGrapes/scheduler/work_stealing_scheduler.hpp>
+
+namespace rg = redGrapes;
+
+namespace
+{
+
+//! emplace tasks with gaps in between, so that the workers run out of work
+void emplace_with_gaps( int n )
+{
+    for( int i = 0; i < n; ++i )
+    {
+        rg::emplace_task( []{} );
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+    rg::barrier();
+}
+
+//! parks of each worker of the running pool
+std::vector< uint64_t > parks( unsigned n_workers )
+{
+    std::vector< uint64_t > p( n_workers, 0 );
+    for( auto & t : rg::stats().threads )
+        if( t.worker_id >= 0 && unsigned( t.worker_id ) < n_workers )
+            p[ t.worker_id ] = t.parks;
+    return p;
+}
+
+template < typename Pred >
+bool wait_for( Pred pred )
+{
+    for( int i = 0; i < 10000; ++i )
+    {
+        if( pred() )
+            return true;
+        std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+    }
+    return false;
+}
+
+} // namespace
+
+TEST_CASE("SleeperRegistry")
+{
+    rg::init( 4, rg::dispatch::thread::IdlePolicy::park() );
+    auto & scheduler = dynamic_cast< rg::scheduler::WorkStealingScheduler & >( *rg::top_scheduler );
+    auto & sleepers = *scheduler.sleepers;
+
+    // all workers went to sleep
+    REQUIRE( wait_for( [&]{
+        auto p = parks( 4 );
+        for( auto n : p )
+            if( n == 0 )
+                return false;
+        return sleepers.count() == 4;
+    } ) );
+
+    // wake exactly the given worker
+    auto p = parks( 4 );
+    REQUIRE( sleepers.wake( 2 ) );
+    REQUIRE( wait_for( [&]{ return parks( 4 )[2] == p[2] + 1 && sleepers.count() == 4; } ) );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    auto q = parks( 4 );
+    REQUIRE( q[0] == p[0] );
+    REQUIRE( q[1] == p[1] );
+    REQUIRE( q[2] == p[2] + 1 );
+    REQUIRE( q[3] == p[3] );
+
+    REQUIRE_FALSE( sleepers.wake( 7 ) );
+
+    // wake exactly one worker
+    auto sum = []( std::vector< uint64_t > const & v ) { return v[0] + v[1] + v[2] + v[3]; };
+    REQUIRE( sleepers.wake_one() );
+    REQUIRE( wait_for( [&]{ return sum( parks( 4 ) ) == sum( q ) + 1 && sleepers.count() == 4; } ) );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    REQUIRE( sum( parks( 4 ) ) == sum( q ) + 1 );
+
+    // a single task keeps exactly one worker out of the registry
+    std::atomic_bool release( false );
+    rg::emplace_task( [&release]{ while( ! release ) std::this_thread::yield(); } );
+    REQUIRE( wait_for( [&]{ return sleepers.count() == 3; } ) );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    REQUIRE( sleepers.count() == 3 );
+
+    release = true;
+    rg::barrier();
+    REQUIRE( wait_for( [&]{ return sleepers.count() == 4; } ) );
+
+    rg::finalize();
+}
+
+TEST_CASE("IdlePolicyPark")
+{
+    rg::init( 2, rg::dispatch::thread::IdlePolicy::park() );
+    auto before = rg::stats();
+
+    emplace_with_gaps( 10 );
+
+    auto after = rg::stats();
+    REQUIRE( after.total.parks > before.total.parks );
+    REQUIRE( after.total.spin_hits == before.total.spin_hits );
+    REQUIRE( after.total.yield_hits == before.total.yield_hits );
+
+    rg::finalize();
+}
+
+TEST_CASE("IdlePolicySpin")
+{
+    // spins long enough to never park during the test
+    rg::init( 1, rg::dispatch::thread::IdlePolicy( 1u << 30, 0 ) );
+    auto before = rg::stats();
+
+    emplace_with_gaps( 5 );
+
+    auto after = rg::stats();
+    REQUIRE( after.total.spin_hits > before.total.spin_hits );
+    REQUIRE( after.total.yield_hits == before.total.yield_hits );
+    REQUIRE( after.total.parks == before.total.parks );
+
+    rg::finalize();
+}
+
+TEST_CASE("IdlePolicyYield")
+{
+    rg::init( 1, rg::dispatch::thread::IdlePolicy( 0, 1u << 30 ) );
+    auto before = rg::stats();
+
+    emplace_with_gaps( 5 );
+
+    auto after = rg::stats();
+    REQUIRE( after.total.yield_hits > before.total.yield_hits );
+    REQUIRE( after.total.spin_hits == before.total.spin_hits );
+    REQUIRE( after.total.parks == before.total.parks );
+
+    rg::finalize();
+}
+
+/* parks of all workers while running a chain of `n_tasks` tasks,
+ * each emplaced while all workers sleep
+ */
+uint64_t chain_parks( unsigned n_tasks, bool eager )
+{
+    rg::TaskSpace::ScopedEagerInit scoped_eager( eager );
+    rg::init( 4, rg::dispatch::thread::IdlePolicy::park() );
+    auto & sleepers = *dynamic_cast< rg::scheduler::WorkStealingScheduler & >( *rg::top_scheduler ).sleepers;
+    rg::IOResource< int > a;
+
+    REQUIRE( wait_for( [&]{
+        auto p = parks( 4 );
+        for( auto n : p )
+            if( n == 0 )
+                return false;
+        return sleepers.count() == 4;
+    } ) );
+    auto before = rg::stats();
+
+    for( unsigned i = 0; i < n_tasks; ++i )
+        REQUIRE( rg::emplace_task( []( auto a ){ return ++ *a; }, a.write() ).get() == int( i + 1 ) );
+    rg::barrier();
+
+    REQUIRE( wait_for( [&]{ return sleepers.count() == 4; } ) );
+    auto after = rg::stats();
+
+    rg::finalize();
+    return after.total.parks - before.total.parks;
+}
+
+TEST_CASE("SleeperWakeupsPerTask")
+{
+    unsigned n_tasks = 100;
+
+    /* only activating a task wakes a worker, the events
+     * reached on the way and the removal of the task do not
+     */
+    REQUIRE( chain_parks( n_tasks, true ) <= n_tasks + 4 );
+
+    // scheduling the space for initialization wakes one more
+    REQUIRE( chain_parks( n_tasks, false ) <= 2 * n_tasks + 4 );
+}
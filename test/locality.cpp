@@ -0,0 +1,45 @@
+#include <catch/catch.hpp>
+
+#include <redGrapes/redGrapes.hpp>
+#include <redGrapes/resource/ioresource.hpp>
+#include <redGrapes/scheduler/work_stealing_scheduler.hpp>
+
+namespace rg = redGrapes;
+
+TEST_CASE("Locality")
+{
+    rg::init( std::make_shared< rg::scheduler::WorkStealingScheduler >( 2 ) );
+
+    rg::IOResource< int > a, b;
+
+    int writer = rg::emplace_task(
+        []( auto a, auto b )
+        {
+            return int( rg::dispatch::thread::current_worker->id );
+        },
+        a.write(), b.read()).get();
+
+    // only writes are recorded
+    REQUIRE( rg::ResourceUser({ a.read() }).last_writer() == writer );
+    REQUIRE( rg::ResourceUser({ b.write() }).last_writer() == -1 );
+    REQUIRE( rg::ResourceUser({ b.write(), a.read() }).last_writer() == writer );
+
+    // a task activated outside of the pool goes to the mailbox of the last writer
+    rg::scheduler::WorkStealing ready( 2 );
+    rg::emplace_task(
+        [&ready, writer]( auto a )
+        {
+            REQUIRE( ready.preferred_worker( *rg::current_task ) == writer );
+
+            ready.activate_task( *rg::current_task );
+            REQUIRE( ready.queues[ writer ]->mailbox.size_approx() == 1 );
+            REQUIRE( ready.queue_depth() == 1 );
+
+            // other workers take it only from the mailbox
+            REQUIRE( ready.try_next_task() == rg::current_task );
+            REQUIRE( ready.queue_depth() == 0 );
+        },
+        a.read()).get();
+
+    rg::finalize();
+}
@@ -0,0 +1,102 @@
+#include <catch/catch.hpp>
+
+#include <array>
+#include <vector>
+
+#include <redGrapes/parallel_for.hpp>
+#include <redGrapes/redGrapes.hpp>
+#include <redGrapes/resource/fieldresource.hpp>
+#include <redGrapes/resource/ioresource.hpp>
+
+namespace rg = redGrapes;
+
+TEST_CASE("DefaultGrain")
+{
+    rg::init( 4 );
+
+    // four tiles per worker
+    REQUIRE( rg::default_grain( 1600, 4096 ) == 100 );
+    REQUIRE( rg::default_grain( 1601, 4096 ) == 101 );
+
+    // but not less than 4096 items per tile
+    REQUIRE( rg::default_grain( 1600, 8 ) == 512 );
+    REQUIRE( rg::default_grain( 10, 1 ) == 4096 );
+
+    rg::finalize();
+}
+
+TEST_CASE("ParallelFor")
+{
+    rg::init( 4 );
+
+    size_t n = 10000;
+    rg::FieldResource< std::vector< int > > a( new std::vector< int >( n, 0 ) );
+    rg::FieldResource< std::vector< int > > b( new std::vector< int >( n, 0 ) );
+
+    rg::parallel_for(
+        a.write(),
+        []( auto index, int & x ) { x = index[0]; },
+        100 );
+
+    // only the inner area, reading a as a whole
+    rg::parallel_for(
+        b.write().area({ 1 }, { n - 1 }),
+        []( auto index, int & x, auto a ) { x = a[{ index[0] - 1 }] + a[{ index[0] + 1 }]; },
+        0,
+        a.read() );
+
+    int errors = rg::emplace_task(
+        [n]( auto b )
+        {
+            int errors = 0;
+            for( size_t i = 0; i < n; ++i )
+                if( b[{ i }] != ( ( i == 0 || i == n - 1 ) ? 0 : int( 2 * i ) ) )
+                    ++errors;
+            return errors;
+        },
+        b.read() ).get();
+
+    REQUIRE( errors == 0 );
+
+    rg::finalize();
+}
+
+TEST_CASE("ParallelFor2D")
+{
+    rg::init( 4 );
+
+    using Field = std::array< std::array< int, 16 >, 24 >;
+    rg::FieldResource< Field > f( new Field() );
+    rg::IOResource< int > sum;
+
+    // 24 rows of 16 items, split into tiles of 5 rows
+    rg::parallel_for(
+        f.write(),
+        []( auto index, int & x ) { x = index[0] + 100 * index[1]; },
+        5 );
+
+    rg::parallel_for(
+        f.write().area({ 2, 3 }, { 6, 20 }),
+        []( auto index, int & x ) { x = -x; },
+        2 );
+
+    rg::emplace_task(
+        []( auto f, auto sum )
+        {
+            *sum = 0;
+            for( size_t y = 0; y < 24; ++y )
+                for( size_t x = 0; x < 16; ++x )
+                    *sum += f[{ x, y }];
+        },
+        f.read(), sum.write() );
+
+    int expected = 0;
+    for( int y = 0; y < 24; ++y )
+        for( int x = 0; x < 16; ++x )
+            expected += ( x >= 2 && x < 6 && y >= 3 && y < 20 ) ? -( x + 100 * y ) : ( x + 100 * y );
+
+    rg::barrier();
+    REQUIRE( *sum.read() == expected );
+
+    rg::finalize();
+}
@@ -0,0 +1,145 @@
+#include <catch/catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <redGrapes/redGrapes.hpp>
+#include <redGrapes/resource/ioresource.hpp>
+#include <redGrapes/scheduler/critical_path_scheduler.hpp>
+#include <redGrapes/scheduler/priority_scheduler.hpp>
+
+namespace rg = redGrapes;
+
+// PriorityProperty can not be part of the tasks of this test binary,
+// since all test cases have to share the same task properties,
+// it is tested in priority_property.cpp
+struct IDPriority
+{
+    int operator() ( rg::Task const & task ) const
+    {
+        return task.task_id % 4;
+    }
+};
+
+TEST_CASE("PriorityScheduler")
+{
+    // activate tasks already at emplacement
+    rg::TaskSpace::ScopedEagerInit eager;
+    rg::init( std::make_shared< rg::scheduler::PriorityScheduler< IDPriority > >(
+        1,
+        rg::dispatch::thread::IdlePolicy(),
+        rg::dispatch::thread::PinningPolicy::COMPACT,
+        4 ) );
+
+    // keep the only worker busy until all tasks are ready
+    std::atomic< bool > started( false ), go( false );
+    rg::emplace_task(
+        [&started, &go]
+        {
+            started = true;
+            while( ! go )
+                std::this_thread::yield();
+        });
+
+    while( ! started )
+        std::this_thread::yield();
+
+    // only written by the worker
+    std::vector< int > priorities;
+    for( int i = 0; i < 64; ++i )
+        rg::emplace_task( [&priorities]{ priorities.push_back( rg::current_task->task_id % 4 ); } );
+
+    REQUIRE( rg::stats().ready_queue_depth == 64 );
+
+    go = true;
+    rg::barrier();
+
+    REQUIRE( priorities.size() == 64 );
+    REQUIRE( std::is_sorted( priorities.rbegin(), priorities.rend() ) );
+
+    rg::finalize();
+}
+
+TEST_CASE("CriticalPathScheduler")
+{
+    rg::TaskSpace::ScopedEagerInit eager;
+    rg::init( std::make_shared< rg::scheduler::CriticalPathScheduler >( 1 ) );
+
+    // all other tasks wait for this one, so they become ready
+    // only after the whole graph is known
+    rg::IOResource< int > gate, a;
+    std::atomic< bool > started( false ), go( false );
+    rg::emplace_task(
+        [&started, &go]( auto gate )
+        {
+            started = true;
+            while( ! go )
+                std::this_thread::yield();
+        },
+        gate.write());
+
+    while( ! started )
+        std::this_thread::yield();
+
+    // only written by the worker
+    std::vector< char > order;
+
+    for( int i = 0; i < 8; ++i )
+        rg::emplace_task( [&order]( auto gate ){ order.push_back( 'i' ); }, gate.read() );
+
+    // emplaced last, but the chain is the longest path
+    for( int i = 0; i < 5; ++i )
+        rg::emplace_task( [&order]( auto gate, auto a ){ order.push_back( 'c' ); }, gate.read(), a.write() );
+
+    go = true;
+    rg::barrier();
+
+    REQUIRE( std::string( order.begin(), order.end() ) == "ccccciiiiiiii" );
+
+    rg::finalize();
+}
+
+TEST_CASE("CriticalPathRanks")
+{
+    rg::TaskSpace::ScopedEagerInit eager;
+    auto other = std::make_shared< rg::scheduler::CriticalPathScheduler >( 1 );
+    rg::init( std::make_shared< rg::scheduler::CriticalPathScheduler >( 1 ) );
+
+    // another scheduler going away must not stop the tracking of the first
+    other.reset();
+    REQUIRE( rg::scheduler::rank::enabled() );
+
+    rg::IOResource< int > gate, a;
+    std::atomic< bool > started( false ), go( false );
+    rg::emplace_task(
+        [&started, &go]( auto gate )
+        {
+            started = true;
+            while( ! go )
+                std::this_thread::yield();
+        },
+        gate.write());
+
+    while( ! started )
+        std::this_thread::yield();
+
+    // only written by the worker
+    std::vector< uint64_t > ranks;
+    for( int i = 0; i < 5; ++i )
+        rg::emplace_task(
+            [&ranks]( auto gate, auto a ){ ranks.push_back( rg::current_task->upward_rank ); },
+            gate.read(), a.write() );
+
+    go = true;
+    rg::barrier();
+
+    // no history yet, so each task of the chain adds the default cost
+    REQUIRE( ranks.size() == 5 );
+    for( int i = 0; i < 5; ++i )
+        REQUIRE( ranks[ i ] == ( 5 - i ) * rg::scheduler::rank::default_cost_ns );
+
+    rg::finalize();
+    REQUIRE( ! rg::scheduler::rank::enabled() );
+}
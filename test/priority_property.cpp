@@ -0,0 +1,54 @@
+#include <catch/catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <redGrapes/task/property/priority.hpp>
+
+#define REDGRAPES_TASK_PROPERTIES redGrapes::PriorityProperty
+
+#include <redGrapes/redGrapes.hpp>
+#include <redGrapes/scheduler/priority_scheduler.hpp>
+
+namespace rg = redGrapes;
+
+// built as its own binary, since all test cases
+// of one binary have to share the same task properties
+TEST_CASE("PriorityProperty")
+{
+    // activate tasks already at emplacement
+    rg::TaskSpace::ScopedEagerInit eager;
+    rg::init( std::make_shared< rg::scheduler::PriorityScheduler<> >( 1 ) );
+
+    // keep the only worker busy until all tasks are ready
+    std::atomic< bool > started( false ), go( false );
+    rg::emplace_task(
+        [&started, &go]
+        {
+            started = true;
+            while( ! go )
+                std::this_thread::yield();
+        });
+
+    while( ! started )
+        std::this_thread::yield();
+
+    // only written by the worker
+    std::vector< int > priorities;
+    for( int i = 0; i < 64; ++i )
+        rg::emplace_task(
+            [&priorities]{ priorities.push_back( rg::current_task->priority ); },
+            rg::TaskProperties::Builder().priority( ( i * 5 ) % 8 ) );
+
+    go = true;
+    rg::barrier();
+
+    REQUIRE( priorities.size() == 64 );
+    REQUIRE( std::is_sorted( priorities.rbegin(), priorities.rend() ) );
+    REQUIRE( priorities.front() == 7 );
+    REQUIRE( priorities.back() == 0 );
+
+    rg::finalize();
+}
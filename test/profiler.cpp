@@ -0,0 +1,38 @@
+#include <catch/catch.hpp>
+
+#include <chrono>
+#include <thread>
+
+#include <redGrapes/redGrapes.hpp>
+#include <redGrapes/resource/ioresource.hpp>
+#include <redGrapes/trace/profiler.hpp>
+
+TEST_CASE("Profiler")
+{
+    namespace rg = redGrapes;
+
+    rg::profiler::enable( 2 );
+    rg::init(4);
+
+    auto sleep = []{ std::this_thread::sleep_for( std::chrono::milliseconds(10) ); };
+
+    // a chain of three tasks and three independent ones
+    rg::IOResource< int > a;
+    for( int i = 0; i < 3; ++i )
+        rg::emplace_task( [sleep]( auto a ){ sleep(); }, a.write() );
+
+    for( int i = 0; i < 3; ++i )
+        rg::emplace_task( sleep );
+
+    rg::finalize();
+    REQUIRE( ! rg::profiler::enabled() );
+
+    auto report = rg::profiler::last_report();
+    REQUIRE( report.n_tasks == 6 );
+    REQUIRE( report.work_ns >= 60000000 );
+    REQUIRE( report.span_ns >= 30000000 );
+    REQUIRE( report.span_ns < report.work_ns );
+    REQUIRE( report.parallelism > 1.5 );
+    REQUIRE( report.critical_path.size() == 2 );
+    REQUIRE( report.critical_path[0].duration_ns >= report.critical_path[1].duration_ns );
+}
@@ -0,0 +1,127 @@
+#include <catch/catch.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include <redGrapes/redGrapes.hpp>
+#include <redGrapes/resource/reductionresource.hpp>
+
+namespace rg = redGrapes;
+
+TEST_CASE("ReductionResource")
+{
+    rg::init( 4 );
+
+    rg::ReductionResource< long > sum;
+
+    for( long i = 0; i < 1000; ++i )
+        rg::emplace_task( [i]( auto s ) { s.combine( i ); }, sum.reduce() );
+
+    REQUIRE( rg::emplace_task( []( auto s ) { return *s; }, sum.read() ).get() == 499500 );
+
+    // a write orders the reductions before and after it
+    for( long i = 0; i < 100; ++i )
+        rg::emplace_task( []( auto s ) { s.local() += 1; }, sum.reduce() );
+    rg::emplace_task( []( auto s ) { *s = *s % 1000; }, sum.write() );
+    for( long i = 0; i < 100; ++i )
+        rg::emplace_task( []( auto s ) { s.local() += 2; }, sum.reduce() );
+
+    REQUIRE( rg::emplace_task( []( auto s ) { return *s; }, sum.read() ).get() == 800 );
+
+    rg::finalize();
+}
+
+TEST_CASE("ReductionResourceHistogram")
+{
+    rg::init( 4 );
+
+    using Histogram = std::vector< int >;
+    auto add = []( Histogram a, Histogram const & b )
+    {
+        for( size_t i = 0; i < a.size(); ++i )
+            a[ i ] += b[ i ];
+        return a;
+    };
+
+    rg::ReductionResource< Histogram, decltype( add ) > hist( Histogram( 10, 0 ), Histogram( 10, 0 ), add );
+
+    for( int t = 0; t < 64; ++t )
+        rg::emplace_task(
+            [t]( auto h )
+            {
+                Histogram & local = h.local();
+                for( int i = 0; i < 100; ++i )
+                    local[ ( t * 100 + i ) % 10 ]++;
+            },
+            hist.reduce() );
+
+    Histogram result = rg::emplace_task( []( auto h ) { return *h; }, hist.read() ).get();
+    REQUIRE( result == Histogram( 10, 640 ) );
+
+    rg::finalize();
+}
+
+TEST_CASE("ReductionResourcePartials")
+{
+    rg::ReductionResource< long > sum;
+
+    auto partials = [&sum]
+    {
+        std::vector< rg::reductionresource::State< long, std::plus< long > >::Partial * > ps;
+        for( auto p = sum.obj->partials.load(); p; p = p->next )
+            ps.push_back( p );
+        return ps;
+    };
+
+    for( unsigned n_workers : { 4, 2, 1 } )
+    {
+        rg::init( n_workers );
+
+        for( long i = 0; i < 1000; ++i )
+            rg::emplace_task( [i]( auto s ) { s.combine( i ); s.combine( i ); }, sum.reduce() );
+
+        rg::emplace_task( []( auto s ) { return *s; }, sum.read() ).get();
+
+        // partials of the workers of earlier rounds are gone
+        REQUIRE( partials().size() <= n_workers + 1 );
+        for( auto p : partials() )
+        {
+            REQUIRE( uintptr_t( p ) % 64 == 0 );
+            REQUIRE( p->value == 0 );
+        }
+
+        rg::finalize();
+    }
+
+    rg::init( 1 );
+    REQUIRE( rg::emplace_task( []( auto s ) { return *s; }, sum.read() ).get() == 3 * 999000 );
+    rg::finalize();
+}
+
+TEST_CASE("ReductionResourceReplay")
+{
+    rg::init( 3 );
+
+    rg::ReductionResource< long > sum;
+
+    // the guard is taken by reference, so a cached partial
+    // must not outlive the merges which drop it
+    auto step = rg::record( [&] {
+        for( int i = 0; i < 4; ++i )
+            rg::emplace_task( []( auto const & s ) { s.combine( 1 ); }, sum.reduce() );
+    } );
+
+    long expected = 4;
+    for( int i = 0; i < 20; ++i )
+    {
+        step.replay();
+        expected += 4;
+        REQUIRE( rg::emplace_task( []( auto s ) { return *s; }, sum.read() ).get() == expected );
+
+        rg::emplace_task( []( auto const & s ) { s.combine( 1 ); }, sum.reduce() );
+        expected += 1;
+        REQUIRE( rg::emplace_task( []( auto s ) { return *s; }, sum.read() ).get() == expected );
+    }
+
+    rg::finalize();
+}
@@ -0,0 +1,198 @@
+#include <catch/catch.hpp>
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <redGrapes/redGrapes.hpp>
+#include <redGrapes/resource/ioresource.hpp>
+#include <redGrapes/task/replay.hpp>
+
+namespace rg = redGrapes;
+
+TEST_CASE("ReplayPlan")
+{
+    rg::IOResource< int > a, b;
+
+    rg::ResourceUser w0({ a.write() });
+    rg::ResourceUser r1({ a.read() });
+    rg::ResourceUser r2({ a.read() });
+    rg::ResourceUser w3({ a.write(), b.read() });
+    rg::ResourceUser w4({ a.write() });
+
+    auto plan = rg::build_replay_plan({ &w0, &r1, &r2, &w3, &w4 });
+    REQUIRE( plan->n_slots == 2 );
+
+    // the first access to a resource has to search the task list
+    REQUIRE( plan->nodes[0].preceding.empty() );
+    REQUIRE( ! plan->nodes[0].covered );
+
+    REQUIRE( plan->nodes[1].preceding == std::vector< unsigned >{ 0 } );
+    REQUIRE( plan->nodes[1].covered );
+    REQUIRE( plan->nodes[2].preceding == std::vector< unsigned >{ 0 } );
+    REQUIRE( plan->nodes[2].covered );
+
+    // the writer follows the readers and drops them from the frontier
+    REQUIRE( plan->nodes[3].preceding == std::vector< unsigned >{ 0, 1, 2 } );
+    REQUIRE( plan->nodes[3].dominated.size() == 3 );
+    REQUIRE( ! plan->nodes[3].covered );
+
+    REQUIRE( plan->nodes[4].preceding == std::vector< unsigned >{ 3 } );
+    REQUIRE( plan->nodes[4].covered );
+}
+
+TEST_CASE("TaskGraph")
+{
+    rg::init( 4 );
+
+    rg::IOResource< int > a, b;
+    rg::IOResource< std::vector< int > > log;
+
+    auto step = rg::record( [&] {
+        rg::emplace_task( []( auto a ) { *a = *a * 3 + 1; }, a.write() );
+        rg::emplace_task( []( auto a, auto b ) { *b = *b * 5 + *a; }, a.read(), b.write() );
+        rg::emplace_task( []( auto a, auto l ) { l->push_back( *a % 1000 ); }, a.read(), log.write() );
+        rg::emplace_task( []( auto a, auto b ) { *a = ( *a + *b ) % 100003; }, a.write(), b.read() );
+    } );
+
+    REQUIRE( step.size() == 4 );
+    REQUIRE( step.replayable() );
+
+    int x = 0, y = 0;
+    std::vector< int > expected;
+    auto ref_step = [&] {
+        x = x * 3 + 1;
+        y = y * 5 + x;
+        expected.push_back( x % 1000 );
+        x = ( x + y ) % 100003;
+    };
+    ref_step();
+
+    rg::ThreadStats before = rg::stats().total;
+
+    for( int i = 0; i < 50; ++i )
+    {
+        step.replay();
+        ref_step();
+
+        // tasks outside of the graph in between
+        if( i % 7 == 0 )
+        {
+            rg::emplace_task( []( auto b ) { *b = *b % 997; }, b.write() );
+            y = y % 997;
+        }
+    }
+
+    rg::barrier();
+
+    REQUIRE( *a.read() == x );
+    REQUIRE( *b.read() == y );
+    REQUIRE( *log.read() == expected );
+
+    /* only the last task covers all of its accesses. Tasks emplaced
+     * between two replays are ordered before the whole replay,
+     * so they do not invalidate the plan.
+     */
+    rg::ThreadStats after = rg::stats().total;
+    REQUIRE( after.replay_plan_hits - before.replay_plan_hits == 50 );
+    REQUIRE( after.replay_plan_misses == before.replay_plan_misses );
+
+    rg::finalize();
+}
+
+TEST_CASE("TaskGraphInterrupted")
+{
+    rg::init( 1 );
+
+    rg::IOResource< int > a, b;
+
+    auto step = rg::record( [&] {
+        rg::emplace_task( []( auto a, auto b ) { *a += 1; }, a.write(), b.write() );
+        rg::emplace_task( []( auto a, auto b ) { *a += *b; }, a.write(), b.read() );
+    } );
+
+    rg::barrier();
+    rg::ThreadStats before = rg::stats().total;
+
+    // the second task is covered by the first one
+    rg::emplace_task( [&step]( auto a, auto b ) { step.replay(); }, a.write(), b.write() );
+    rg::barrier();
+
+    rg::ThreadStats after = rg::stats().total;
+    REQUIRE( after.replay_plan_hits - before.replay_plan_hits == 1 );
+    REQUIRE( after.replay_plan_misses == before.replay_plan_misses );
+
+    /* the parent task also emplaces a task into the top space, after
+     * the replay. The only worker then initializes the children up to
+     * the first one, which is ready, and then the other task, so the
+     * second child has to search the task lists.
+     * Both spaces are enqueued by the worker, which keeps their order.
+     */
+    std::atomic< bool > done( false );
+    rg::emplace_task(
+        [&step, &done, &b]( auto a, auto )
+        {
+            step.replay();
+
+            rg::Task * parent = rg::current_task;
+            rg::current_task = nullptr;
+            rg::emplace_task( [&done]( auto b ) { done = true; }, b.read() );
+            rg::current_task = parent;
+        },
+        a.write(), b.write() );
+
+    // do not initialize tasks from this thread
+    while( ! done )
+        std::this_thread::yield();
+
+    rg::barrier();
+
+    rg::ThreadStats tainted = rg::stats().total;
+    REQUIRE( tainted.replay_plan_hits == after.replay_plan_hits );
+    REQUIRE( tainted.replay_plan_misses - after.replay_plan_misses == 1 );
+    REQUIRE( *a.read() == 3 );
+
+    rg::finalize();
+}
+
+TEST_CASE("TaskGraphNotCopyable")
+{
+    rg::init( 1 );
+
+    rg::IOResource< int > a;
+    auto p = std::make_shared< int >( 1 );
+
+    auto g = rg::record( [&] {
+        rg::emplace_task( [p]( auto a ) { *a += *p; }, a.write() );
+        rg::emplace_task( []( std::unique_ptr< int > const & q ) {}, std::make_unique< int >( 2 ) );
+    } );
+
+    REQUIRE( g.size() == 2 );
+    REQUIRE( ! g.replayable() );
+    REQUIRE_THROWS_AS( g.replay(), std::runtime_error );
+
+    rg::finalize();
+}
+
+TEST_CASE("TaskGraphCopiesCallable")
+{
+    rg::init( 2 );
+
+    rg::IOResource< int > a;
+
+    // the callable changes its own state
+    auto step = rg::record( [&] {
+        rg::emplace_task( [n = 0]( auto a ) mutable { *a += ++n; }, a.write() );
+    } );
+
+    // every replay starts with a fresh copy of the recorded state
+    for( int i = 0; i < 3; ++i )
+        step.replay();
+
+    rg::barrier();
+    REQUIRE( *a.read() == 4 );
+
+    rg::finalize();
+}
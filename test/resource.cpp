@@ -3,6 +3,7 @@
 
 #include <redGrapes/resource/resource.hpp>
 #include <redGrapes/resource/ioresource.hpp>
+#include <redGrapes/resource/access/field.hpp>
 
 struct Access
 {
@@ -31,6 +32,36 @@ struct fmt::formatter<Access>
     }
 };
 
+//! too large to be stored inline in a ResourceAccess
+struct LargeAccess
+{
+    std::array< size_t, 32 > index;
+
+    static bool is_serial(LargeAccess const & a, LargeAccess const & b)
+    { return a.index[31] == b.index[31]; }
+
+    bool is_superset_of(LargeAccess const & a) const
+    { return index[31] == a.index[31]; }
+
+    bool operator==(LargeAccess const & other) const
+    { return index == other.index; }
+};
+
+template<>
+struct fmt::formatter<LargeAccess>
+{
+    constexpr auto parse(format_parse_context& ctx)
+    {
+        return ctx.begin();
+    }
+
+    template<typename FormatContext>
+    auto format(LargeAccess const& acc, FormatContext& ctx)
+    {
+        return fmt::format_to(ctx.out(), "{}", acc.index[31]);
+    }
+};
+
 TEST_CASE("Resource ID")
 {
     redGrapes::Resource< Access > a, b;
@@ -73,3 +104,43 @@ TEST_CASE("IOResource")
     REQUIRE( redGrapes::ResourceAccess::is_serial(b.write(), a.write()) == false );
 }
 
+
+TEST_CASE("ResourceAccess storage")
+{
+    using redGrapes::ResourceAccess;
+    using Field = redGrapes::access::FieldAccess<3>;
+
+    redGrapes::Resource< Field > f;
+    redGrapes::Resource< LargeAccess > l;
+
+    // inline
+    ResourceAccess f1 = f.make_access( Field( redGrapes::access::IOAccess::write ) );
+    ResourceAccess f2 = f1;
+    ResourceAccess f3 = std::move( f2 );
+    REQUIRE( f3 == f1 );
+    REQUIRE( ResourceAccess::is_serial( f1, f3 ) );
+    REQUIRE( f1.is_superset_of( f3 ) );
+
+    // heap allocated
+    LargeAccess la;
+    la.index.fill( 1 );
+    ResourceAccess l1 = l.make_access( la );
+    ResourceAccess l2 = l1;
+    REQUIRE( l2 == l1 );
+    REQUIRE( ResourceAccess::is_serial( l1, l2 ) );
+    REQUIRE( l2.mode_format() == "1" );
+
+    la.index[31] = 2;
+    l2 = l.make_access( la );
+    REQUIRE( ! ( l2 == l1 ) );
+    REQUIRE( ! ResourceAccess::is_serial( l1, l2 ) );
+
+    // different policies never conflict
+    REQUIRE( f1.policy_id() != l1.policy_id() );
+    REQUIRE( ! ResourceAccess::is_serial( f1, l1 ) );
+    REQUIRE( ! f1.is_same_resource( l1 ) );
+
+    l1 = f1;
+    REQUIRE( l1 == f1 );
+    REQUIRE( l1.policy_id() == f1.policy_id() );
+}
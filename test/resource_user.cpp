@@ -1,6 +1,10 @@
 
 #include <catch/catch.hpp>
 
+#include <algorithm>
+#include <random>
+#include <vector>
+
 #include <redGrapes/resource/ioresource.hpp>
 #include <redGrapes/resource/resource_user.hpp>
 
@@ -58,3 +62,45 @@ TEST_CASE("Resource User")
     REQUIRE( f2.is_superset_of(f5) == false );
 }
 
+
+TEST_CASE("Resource User many resources")
+{
+    using redGrapes::ResourceUser;
+
+    std::vector< redGrapes::IOResource<int> > res( 40 );
+    std::mt19937 gen( 7 );
+
+    auto random_user = [&]
+    {
+        ResourceUser u;
+        for( int i = 0; i < 30; ++i )
+        {
+            auto & r = res[ gen() % res.size() ];
+            if( gen() % 2 )
+                u.add_resource_access( r.read() );
+            else
+                u.add_resource_access( r.write() );
+        }
+        return u;
+    };
+
+    for( int n = 0; n < 100; ++n )
+    {
+        ResourceUser a = random_user();
+        ResourceUser b = random_user();
+
+        REQUIRE( std::is_sorted( a.access_list.begin(), a.access_list.end(),
+                     []( auto const & x, auto const & y ){ return x.resource_id() < y.resource_id(); } ) );
+        REQUIRE( std::is_sorted( a.unique_resources.begin(), a.unique_resources.end(),
+                     []( auto const & x, auto const & y ){ return x.resource.id < y.resource.id; } ) );
+
+        bool serial = false;
+        for( auto & ra : a.access_list )
+            for( auto & rb : b.access_list )
+                if( redGrapes::ResourceAccess::is_serial( ra, rb ) )
+                    serial = true;
+
+        REQUIRE( ResourceUser::is_serial( a, b ) == serial );
+        REQUIRE( ResourceUser::is_serial( b, a ) == serial );
+    }
+}
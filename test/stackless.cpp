@@ -0,0 +1,115 @@
+#include <catch/catch.hpp>
+
+#include <atomic>
+#include <optional>
+#include <thread>
+
+#include <redGrapes/redGrapes.hpp>
+#include <redGrapes/resource/ioresource.hpp>
+
+namespace rg = redGrapes;
+
+TEST_CASE("Stackless")
+{
+    rg::init( 1 );
+
+    // by default tasks run on the stack of the worker
+    REQUIRE( rg::emplace_task( []{ return rg::current_task->is_stackless(); } ).get() );
+    REQUIRE_FALSE( rg::emplace_task(
+                       []{ return rg::current_task->is_stackless(); },
+                       rg::TaskProperties::Builder().may_yield() ).get() );
+
+    auto before = rg::stats();
+
+    // the only worker executes the child while the parent waits
+    int x = rg::emplace_task(
+        []
+        {
+            return rg::emplace_task( []{ return 21; } ).get() * 2;
+        }).get();
+    REQUIRE( x == 42 );
+
+    auto after = rg::stats();
+    REQUIRE( after.total.yields == before.total.yields );
+    REQUIRE( after.total.stackless_waits - before.total.stackless_waits <= 1 );
+
+    // a task with may_yield is paused instead
+    x = rg::emplace_task(
+        []
+        {
+            return rg::emplace_task( []{ return 21; } ).get() * 2;
+        },
+        rg::TaskProperties::Builder().may_yield() ).get();
+    REQUIRE( x == 42 );
+
+    rg::finalize();
+}
+
+TEST_CASE("StacklessNested")
+{
+    rg::init( 2 );
+
+    std::atomic< int > sum{ 0 };
+
+    for( int i = 0; i < 32; ++i )
+        rg::emplace_task(
+            [i, &sum]
+            {
+                // a waiting parent may execute the children of other parents
+                auto a = rg::emplace_task( [i]{ return i; } );
+                auto b = rg::emplace_task( [i]{ return 2 * i; } );
+                auto c = rg::emplace_task( [i]{ return 3 * i; } );
+
+                sum += a.get() + b.get() + c.get();
+            },
+            rg::TaskProperties::Builder().may_yield( i % 2 == 0 ) );
+
+    rg::barrier();
+    REQUIRE( sum == 32 * 31 / 2 * 6 );
+
+    rg::finalize();
+}
+
+TEST_CASE("StacklessCycle")
+{
+    rg::init( 1 );
+
+    rg::IOResource< int > s;
+    std::optional< rg::scheduler::EventPtr > x;
+    std::atomic< bool > x_created{ false };
+    std::atomic< bool > b_started{ false };
+
+    // A holds s while it waits for x
+    rg::emplace_task(
+        [&]( auto s )
+        {
+            x = rg::create_event();
+            x_created = true;
+            rg::yield( *x );
+            *s = 1;
+        },
+        s.write() );
+
+    // Y can only start after A finished
+    auto y = rg::emplace_task( []( auto s ){ return *s + 1; }, s.write() );
+
+    while( ! x_created )
+        std::this_thread::yield();
+
+    // the only worker executes B while A waits, and B waits for Y.
+    // On the stack of A, B would keep A from ever returning.
+    auto b = rg::emplace_task(
+        [&]
+        {
+            b_started = true;
+            return y.get();
+        });
+
+    while( ! b_started )
+        std::this_thread::yield();
+    x->notify();
+
+    REQUIRE( b.get() == 2 );
+
+    rg::finalize();
+}
@@ -0,0 +1,42 @@
+#include <catch/catch.hpp>
+
+#include <redGrapes/redGrapes.hpp>
+#include <redGrapes/resource/ioresource.hpp>
+
+TEST_CASE("Stats")
+{
+    namespace rg = redGrapes;
+
+    rg::init(2);
+
+    auto before = rg::stats();
+
+    rg::IOResource< int > a;
+    for( int i = 0; i < 100; ++i )
+        rg::emplace_task( []( auto a ){ *a += 1; }, a.write() );
+
+    // waits for the child without yielding
+    rg::emplace_task(
+        []
+        {
+            rg::emplace_task( []{} ).get();
+        });
+
+    rg::barrier();
+
+    auto after = rg::stats();
+    REQUIRE( after.total.tasks_created - before.total.tasks_created == 102 );
+    REQUIRE( after.total.tasks_executed - before.total.tasks_executed == 102 );
+    REQUIRE( after.total.resumes - before.total.resumes == after.total.yields - before.total.yields );
+    REQUIRE( after.total.event_notifications > before.total.event_notifications );
+    REQUIRE( after.total.update_calls > before.total.update_calls );
+    REQUIRE( after.allocator_chunks > 0 );
+
+    unsigned n_workers = 0;
+    for( auto & t : after.threads )
+        if( t.worker_id >= 0 )
+            n_workers++;
+    REQUIRE( n_workers >= 2 );
+
+    rg::finalize();
+}
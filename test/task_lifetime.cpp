@@ -0,0 +1,115 @@
+#include <catch/catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <redGrapes/redGrapes.hpp>
+#include <redGrapes/resource/ioresource.hpp>
+#include <redGrapes/scheduler/work_stealing_scheduler.hpp>
+
+namespace rg = redGrapes;
+
+TEST_CASE("TaskLifetime")
+{
+    rg::init( 4 );
+
+    rg::IOResource< int > a;
+    std::atomic< int > parent_removed_early{ 0 };
+
+    // each token is owned only by the callable of one task
+    std::vector< std::weak_ptr< int > > tokens;
+
+    for( int i = 0; i < 64; ++i )
+    {
+        auto token = std::make_shared< int >( i );
+        tokens.push_back( token );
+        std::weak_ptr< int > parent = token;
+
+        rg::emplace_task(
+            [token, parent, &parent_removed_early]( auto a )
+            {
+                // the parent finishes before its children,
+                // but must not be removed until they finished too
+                rg::emplace_task(
+                    [parent, &parent_removed_early]
+                    {
+                        std::this_thread::sleep_for( std::chrono::microseconds( 200 ) );
+                        if( parent.expired() )
+                            ++parent_removed_early;
+                    });
+                *a += 1;
+            },
+            a.write() );
+    }
+
+    // the result of these tasks is never taken
+    for( int i = 0; i < 64; ++i )
+    {
+        auto token = std::make_shared< int >( i );
+        tokens.push_back( token );
+        rg::emplace_task( [token]{ return *token; } );
+    }
+
+    // and the result of these is taken
+    for( int i = 0; i < 64; ++i )
+    {
+        auto token = std::make_shared< int >( i );
+        tokens.push_back( token );
+        REQUIRE( rg::emplace_task( [token]{ return *token; } ).get() == i );
+    }
+
+    rg::barrier();
+
+    REQUIRE( parent_removed_early == 0 );
+
+    // every task was removed, exactly once
+    for( auto & token : tokens )
+        REQUIRE( token.expired() );
+
+    rg::finalize();
+}
+
+TEST_CASE("TaskLifetimeYield")
+{
+    rg::init( 2 );
+
+    rg::IOResource< int > a;
+    std::atomic< int > sum{ 0 };
+
+    // paused tasks are activated exactly once when their event is reached
+    for( int i = 0; i < 100; ++i )
+        rg::emplace_task(
+            [&sum]( auto a )
+            {
+                int x = rg::emplace_task( []{ return 1; } ).get();
+                sum += x;
+                *a += x;
+            },
+            a.write() );
+
+    rg::barrier();
+    REQUIRE( sum == 100 );
+    REQUIRE( *a == 100 );
+
+    rg::finalize();
+}
+
+TEST_CASE("FinalizeSharedScheduler")
+{
+    // the caller keeps its own reference to the scheduler
+    auto scheduler = std::make_shared< rg::scheduler::WorkStealingScheduler >( 2 );
+    rg::init( scheduler );
+
+    rg::IOResource< int > a;
+    for( int i = 0; i < 100; ++i )
+        rg::emplace_task( []( auto a ){ *a += 1; }, a.write() );
+
+    rg::finalize();
+
+    // all workers are joined
+    REQUIRE( scheduler->n_workers() == 0 );
+    REQUIRE( scheduler.use_count() == 1 );
+}
@@ -0,0 +1,170 @@
+#include <catch/catch.hpp>
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include <redGrapes/redGrapes.hpp>
+#include <redGrapes/resource/fieldresource.hpp>
+#include <redGrapes/resource/ioresource.hpp>
+
+namespace rg = redGrapes;
+
+TEST_CASE("TaskRange")
+{
+    rg::init( 4 );
+
+    size_t n = 256;
+    rg::FieldResource< std::vector< int > > field[2] = {
+        rg::FieldResource< std::vector< int > >( new std::vector< int >( n, 0 ) ),
+        rg::FieldResource< std::vector< int > >( new std::vector< int >( n, 0 ) ),
+    };
+    rg::IOResource< int > sum;
+
+    rg::emplace_task_range(
+        size_t(0), n,
+        []( size_t i, auto dst ) { dst[{i}] = i; },
+        [&]( size_t i ) { return std::make_tuple( field[0].at({i}).write() ); } );
+
+    // each step shifts the field by one, ordered after the previous step
+    for( int step = 0; step < 10; ++step )
+    {
+        auto & src = field[ step % 2 ];
+        auto & dst = field[ ( step + 1 ) % 2 ];
+
+        rg::emplace_task_range(
+            size_t(0), n,
+            [n]( size_t i, auto dst, auto src ) { dst[{i}] = src[{( i + n - 1 ) % n}]; },
+            [&]( size_t i ) {
+                return std::make_tuple( dst.at({i}).write(), src.at({( i + n - 1 ) % n}).read() );
+            } );
+    }
+
+    // a task accessing the whole field follows all tasks of the range
+    rg::emplace_task(
+        []( auto f, auto sum )
+        {
+            *sum = 0;
+            for( size_t i = 0; i < f->size(); ++i )
+                *sum += f[{i}] * ( i % 3 );
+        },
+        field[0].read(), sum.write() );
+
+    int expected = 0;
+    for( size_t i = 0; i < n; ++i )
+        expected += int( ( i + n - 10 ) % n ) * ( i % 3 );
+
+    rg::barrier();
+    REQUIRE( *sum.read() == expected );
+
+    // empty range
+    rg::emplace_task_range(
+        5, 5,
+        []( int i, auto sum ) { *sum = -1; },
+        [&]( int i ) { return std::make_tuple( sum.write() ); } );
+
+    rg::barrier();
+    REQUIRE( *sum.read() == expected );
+
+    rg::finalize();
+}
+
+TEST_CASE("TaskRangeChildren")
+{
+    rg::init( 4 );
+
+    rg::IOResource< std::vector< int > > v;
+    std::atomic< int > count{ 0 };
+
+    rg::emplace_task(
+        [&count]( auto v )
+        {
+            v->resize( 100 );
+            rg::emplace_task_range(
+                0, 100,
+                [&count]( int i, auto v ) { ++count; },
+                [&v]( int i ) { return std::make_tuple( v.read() ); } );
+        },
+        v.write() );
+
+    // the parent only finishes after its children
+    rg::emplace_task( [&count]( auto v ) { REQUIRE( count == 100 ); }, v.write() );
+
+    rg::barrier();
+    REQUIRE( count == 100 );
+
+    rg::finalize();
+}
+
+TEST_CASE("TaskRangeThrows")
+{
+    rg::init( 2 );
+
+    rg::IOResource< int > a;
+    auto token = std::make_shared< int >( 0 );
+
+    // each constructed task holds a copy of the callable
+    auto f = [token]( int i, auto a ) { *a += i; };
+    REQUIRE_THROWS_AS(
+        rg::emplace_task_range(
+            0, 10, f,
+            [&a]( int i )
+            {
+                if( i == 5 )
+                    throw std::runtime_error("access");
+                return std::make_tuple( a.write() );
+            } ),
+        std::runtime_error );
+
+    // no task of the range was emplaced and all of them are destroyed
+    REQUIRE( token.use_count() == 2 );
+    REQUIRE( rg::stats().top_space_tasks == 0 );
+
+    rg::emplace_task( f, 45, a.write() );
+    rg::barrier();
+    REQUIRE( *a.read() == 45 );
+
+    rg::finalize();
+}
+
+TEST_CASE("TaskRangeOverlapping")
+{
+    rg::init( 4 );
+
+    rg::IOResource< int > a;
+    rg::FieldResource< std::vector< int > > field( new std::vector< int >( 16, 1 ) );
+
+    // every task writes `a`, tiles overlap with their successor
+    rg::emplace_task_range(
+        0, 8,
+        []( int i, auto a, auto f )
+        {
+            *a = *a * 3 + i;
+            for( size_t x = f.area_begin()[ 0 ]; x < f.area_end()[ 0 ]; ++x )
+                f[{ x }] = f[{ x }] * 2 + i;
+        },
+        [&]( int i )
+        {
+            return std::make_tuple( a.write(), field.area({ size_t( 2 * i ) }, { size_t( 2 * i + 4 ) }) );
+        } );
+
+    rg::barrier();
+
+    int expected = 0;
+    std::vector< int > expected_field( 16, 1 );
+    for( int i = 0; i < 8; ++i )
+    {
+        expected = expected * 3 + i;
+        for( int x = 2 * i; x < 2 * i + 4 && x < 16; ++x )
+            expected_field[ x ] = expected_field[ x ] * 2 + i;
+    }
+
+    REQUIRE( *a.read() == expected );
+    auto r = field.read();
+    for( size_t x = 0; x < 16; ++x )
+        REQUIRE( r[{ x }] == expected_field[ x ] );
+
+    rg::finalize();
+}
@@ -1,7 +1,14 @@
 
 #include <catch/catch.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <redGrapes/redGrapes.hpp>
 #include <redGrapes/task/task_space.hpp>
+#include <redGrapes/resource/ioresource.hpp>
 
 struct TestTask
 {
@@ -82,3 +89,192 @@ TEST_CASE("precedence graph")
     */
 }
 
+TEST_CASE("concurrent emplacement")
+{
+    namespace rg = redGrapes;
+    rg::init(4);
+
+    unsigned n_producers = 4;
+    unsigned n_tasks = 5000;
+    std::atomic< unsigned > count( 0 );
+
+    // all producers push into the emplacement queue of the top space
+    std::vector< std::thread > producers;
+    for( unsigned p = 0; p < n_producers; ++p )
+        producers.emplace_back(
+            [&count, n_tasks]
+            {
+                for( unsigned i = 0; i < n_tasks; ++i )
+                    rg::emplace_task( [&count]{ ++count; } );
+            });
+
+    for( auto & t : producers )
+        t.join();
+
+    rg::barrier();
+    REQUIRE( count == n_producers * n_tasks );
+
+    rg::finalize();
+}
+
+//! number of tasks currently registered at a resource
+static unsigned live_users( redGrapes::ResourceBase const & r )
+{
+    std::lock_guard< std::mutex > lock( r.users->mutex );
+    return r.users->tasks.size() - r.users->n_holes;
+}
+
+TEST_CASE("resource frontier")
+{
+    namespace rg = redGrapes;
+    rg::init(4);
+
+    rg::IOResource< int > a;
+    std::atomic< bool > go( false );
+
+    // keeps all following writers waiting
+    rg::emplace_task( [&go]( auto a ) { while( ! go ) std::this_thread::yield(); }, a.write() );
+
+    int n_tasks = 1000;
+    for( int i = 0; i < n_tasks; ++i )
+        rg::emplace_task( []( auto a ) { ++ *a; }, a.write() );
+
+    // every writer covers all older ones, so only the newest one remains
+    auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds( 10 );
+    while( live_users( a ) != 1 && std::chrono::steady_clock::now() < timeout )
+        std::this_thread::yield();
+
+    REQUIRE( live_users( a ) == 1 );
+
+    go = true;
+    rg::barrier();
+
+    REQUIRE( *a == n_tasks );
+    REQUIRE( live_users( a ) == 0 );
+    *a = 0;
+
+    // children of a task are ordered among each other by the resources of their parent
+    std::atomic< bool > ok( true );
+    rg::emplace_task(
+        [&a, &ok]( auto )
+        {
+            for( int i = 0; i < 100; ++i )
+                rg::emplace_task(
+                    [i, &ok]( auto a )
+                    {
+                        if( *a != i )
+                            ok = false;
+                        std::this_thread::yield();
+                        *a = i + 1;
+                    },
+                    a.write());
+        },
+        a.write());
+
+    rg::barrier();
+    REQUIRE( ok );
+
+    rg::finalize();
+}
+
+TEST_CASE("active task spaces")
+{
+    namespace rg = redGrapes;
+    rg::init(4);
+
+    // a running parent whose children are all initialized
+    // does not keep its space in the active list
+    std::atomic< bool > idle_space_dropped( false );
+    rg::emplace_task(
+        [&idle_space_dropped]
+        {
+            for( int i = 0; i < 10; ++i )
+                rg::emplace_task( []{} ).get();
+
+            idle_space_dropped = rg::active_task_spaces.size_approx() == 0;
+        });
+
+    rg::barrier();
+    REQUIRE( idle_space_dropped );
+    REQUIRE( rg::active_task_spaces.size_approx() == 0 );
+
+    // nested spaces
+    std::atomic< int > count( 0 );
+    for( int i = 0; i < 16; ++i )
+        rg::emplace_task(
+            [&count]
+            {
+                for( int j = 0; j < 16; ++j )
+                    rg::emplace_task( [&count]{ rg::emplace_task( [&count]{ ++count; } ); } );
+            });
+
+    rg::barrier();
+    REQUIRE( count == 16 * 16 );
+    REQUIRE( rg::active_task_spaces.size_approx() == 0 );
+
+    rg::finalize();
+}
+
+TEST_CASE("eager initialization")
+{
+    namespace rg = redGrapes;
+
+    bool previous = rg::TaskSpace::default_eager_init();
+    {
+        rg::TaskSpace::ScopedEagerInit eager;
+        REQUIRE( rg::TaskSpace::default_eager_init() );
+    }
+    REQUIRE( rg::TaskSpace::default_eager_init() == previous );
+
+    rg::TaskSpace::ScopedEagerInit eager;
+    rg::init(4);
+
+    REQUIRE( rg::top_space->eager_init );
+
+    rg::IOResource< unsigned > a, b;
+
+    // concurrent insertions into the graph of the same resources
+    unsigned n_producers = 4;
+    unsigned n_tasks = 2000;
+    std::vector< std::thread > producers;
+    for( unsigned p = 0; p < n_producers; ++p )
+        producers.emplace_back(
+            [&a, &b, p, n_tasks]
+            {
+                for( unsigned i = 0; i < n_tasks; ++i )
+                    if( ( p + i ) % 2 )
+                        rg::emplace_task( []( auto a, auto b ){ ++ *a; ++ *b; }, a.write(), b.write() );
+                    else
+                        rg::emplace_task( []( auto b, auto a ){ ++ *a; ++ *b; }, b.write(), a.write() );
+            });
+
+    for( auto & t : producers )
+        t.join();
+
+    rg::barrier();
+    REQUIRE( *a == n_producers * n_tasks );
+    REQUIRE( *b == n_producers * n_tasks );
+    *a = 0;
+
+    // children are initialized by their parent
+    std::atomic< bool > ok( true );
+    rg::emplace_task(
+        [&a, &ok]( auto )
+        {
+            for( unsigned i = 0; i < 100; ++i )
+                rg::emplace_task(
+                    [i, &ok]( auto a )
+                    {
+                        if( *a != i )
+                            ok = false;
+                        *a = i + 1;
+                    },
+                    a.write());
+        },
+        a.write());
+
+    rg::barrier();
+    REQUIRE( ok );
+
+    rg::finalize();
+}
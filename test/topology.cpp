@@ -0,0 +1,111 @@
+#include <catch/catch.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <redGrapes/dispatch/thread/topology.hpp>
+
+namespace thread = redGrapes::dispatch::thread;
+
+using Cpus = std::vector< unsigned >;
+
+TEST_CASE("Topology")
+{
+    REQUIRE( thread::Topology::parse_cpulist( "0-3,8,10-11\n" ) == Cpus({ 0, 1, 2, 3, 8, 10, 11 }) );
+    REQUIRE( thread::Topology::parse_cpulist( "" ).empty() );
+
+    // this machine
+    thread::Topology const & machine = thread::Topology::get();
+    REQUIRE( machine.n_nodes() >= 1 );
+    REQUIRE( machine.n_cpus() >= 1 );
+    REQUIRE( machine.current_node() < machine.n_nodes() );
+
+    // fake sysfs with two nodes and an offline cpu
+    char dir[] = "/tmp/redGrapes_sysfsXXXXXX";
+    REQUIRE( mkdtemp( dir ) != nullptr );
+    std::string root( dir );
+    for( std::string d : { "/cpu", "/node", "/node/node0", "/node/node1" } )
+        mkdir( ( root + d ).c_str(), 0700 );
+    std::ofstream( root + "/cpu/online" ) << "0-6\n";
+    std::ofstream( root + "/node/online" ) << "0-1\n";
+    std::ofstream( root + "/node/node0/cpulist" ) << "0-3\n";
+    std::ofstream( root + "/node/node1/cpulist" ) << "4-7\n";
+
+    thread::Topology fake = thread::Topology::discover( root );
+    REQUIRE( fake.n_nodes() == 2 );
+    REQUIRE( fake.node_cpus[ 1 ] == Cpus({ 4, 5, 6 }) );
+    REQUIRE( fake.node_of( 5 ) == 1 );
+
+    for( std::string f : { "/cpu/online", "/node/online", "/node/node0/cpulist", "/node/node1/cpulist" } )
+        std::remove( ( root + f ).c_str() );
+    for( std::string d : { "/cpu", "/node/node0", "/node/node1", "/node", "" } )
+        rmdir( ( root + d ).c_str() );
+}
+
+TEST_CASE("PinningPolicy")
+{
+    thread::Topology t({ { 0, 1, 2, 3 }, { 4, 5, 6, 7 } });
+
+    auto compact = thread::place_workers( t, 4, thread::PinningPolicy::COMPACT );
+    REQUIRE( compact.main_cpus == Cpus({ 0 }) );
+    REQUIRE( compact.worker_cpus[ 0 ] == Cpus({ 1 }) );
+    REQUIRE( compact.worker_cpus[ 3 ] == Cpus({ 4 }) );
+    REQUIRE( compact.worker_node == Cpus({ 0, 0, 0, 1 }) );
+
+    auto scatter = thread::place_workers( t, 4, thread::PinningPolicy::SCATTER );
+    REQUIRE( scatter.main_cpus == Cpus({ 0 }) );
+    REQUIRE( scatter.worker_cpus[ 0 ] == Cpus({ 4 }) );
+    REQUIRE( scatter.worker_cpus[ 1 ] == Cpus({ 1 }) );
+    REQUIRE( scatter.worker_node == Cpus({ 1, 0, 1, 0 }) );
+
+    auto node = thread::place_workers( t, 4, thread::PinningPolicy::NODE );
+    REQUIRE( node.worker_cpus[ 1 ] == Cpus({ 0, 1, 2, 3 }) );
+    REQUIRE( node.worker_cpus[ 2 ] == Cpus({ 4, 5, 6, 7 }) );
+    REQUIRE( node.worker_node == Cpus({ 0, 0, 1, 1 }) );
+
+    // with the default number of workers none shares the cpu of the main thread
+    auto fitting = thread::place_workers( t, t.n_cpus() - 1, thread::PinningPolicy::COMPACT );
+    for( auto & cpus : fitting.worker_cpus )
+        REQUIRE( cpus != fitting.main_cpus );
+
+    // more workers than cpus wrap around
+    auto many = thread::place_workers( t, 9, thread::PinningPolicy::COMPACT );
+    REQUIRE( many.worker_cpus[ 7 ] == Cpus({ 0 }) );
+
+    auto none = thread::place_workers( t, 2, thread::PinningPolicy::NONE );
+    REQUIRE( none.main_cpus.empty() );
+    REQUIRE( none.worker_cpus[ 1 ] == Cpus({ 0, 1, 2, 3, 4, 5, 6, 7 }) );
+
+    // a cpuset which covers only the second node
+    thread::Topology cpuset = t.restrict_to({ 5, 6 });
+    REQUIRE( cpuset.n_nodes() == 2 );
+    REQUIRE( cpuset.node_cpus[ 0 ].empty() );
+
+    auto restricted = thread::place_workers( cpuset, 3, thread::PinningPolicy::COMPACT );
+    REQUIRE( restricted.main_cpus == Cpus({ 5 }) );
+    REQUIRE( restricted.worker_cpus[ 0 ] == Cpus({ 6 }) );
+    REQUIRE( restricted.worker_cpus[ 1 ] == Cpus({ 5 }) );
+    REQUIRE( restricted.worker_node == Cpus({ 1, 1, 1 }) );
+
+    auto restricted_node = thread::place_workers( cpuset, 2, thread::PinningPolicy::NODE );
+    REQUIRE( restricted_node.worker_cpus[ 0 ] == Cpus({ 5, 6 }) );
+    REQUIRE( restricted_node.worker_node == Cpus({ 1, 1 }) );
+}
+
+TEST_CASE("AffinityMask")
+{
+    auto const & mask = thread::Topology::affinity();
+    REQUIRE( ! mask.empty() );
+
+    // workers are only placed on cpus of the process
+    REQUIRE( thread::default_n_workers() == std::max( mask.size() - 1, size_t(1) ) );
+    for( auto & cpus : thread::place_workers( 4, thread::PinningPolicy::COMPACT ).worker_cpus )
+        for( unsigned cpu : cpus )
+            REQUIRE( std::find( mask.begin(), mask.end(), cpu ) != mask.end() );
+}
@@ -0,0 +1,81 @@
+#include <catch/catch.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <redGrapes/redGrapes.hpp>
+#include <redGrapes/trace/tracer.hpp>
+
+static unsigned count( std::string const & s, std::string const & pattern )
+{
+    unsigned n = 0;
+    for( size_t pos = s.find( pattern ); pos != std::string::npos; pos = s.find( pattern, pos + 1 ) )
+        ++n;
+    return n;
+}
+
+TEST_CASE("Tracer")
+{
+    namespace rg = redGrapes;
+
+    std::string path = "redGrapes_test_trace.json";
+    rg::trace::enable( path );
+    rg::init(2);
+
+    for( int i = 0; i < 10; ++i )
+        rg::emplace_task( []{} );
+
+    // the parent waits for its child
+    rg::emplace_task(
+        []
+        {
+            int x = rg::emplace_task( []{ return 1; } ).get();
+            REQUIRE( x == 1 );
+        });
+
+    rg::finalize();
+    REQUIRE( ! rg::trace::enabled() );
+
+    std::ifstream file( path );
+    std::stringstream buf;
+    buf << file.rdbuf();
+    std::string trace = buf.str();
+    std::remove( path.c_str() );
+
+    REQUIRE( trace.find( "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[" ) == 0 );
+    REQUIRE( count( trace, "\"name\":\"create " ) == 12 );
+    REQUIRE( count( trace, "\"begin\":\"start\"" ) == 12 );
+    REQUIRE( count( trace, "\"end\":\"finish\"" ) == 12 );
+    REQUIRE( count( trace, "\"end\":\"yield\"" ) == count( trace, "\"begin\":\"resume\"" ) );
+}
+
+TEST_CASE("TracerLabels")
+{
+    namespace rg = redGrapes;
+
+    rg::trace::LabelID a = rg::trace::intern_label( "a" );
+    REQUIRE( a != 0 );
+    REQUIRE( rg::trace::intern_label( "a" ) == a );
+    REQUIRE( rg::trace::intern_label( "b" ) != a );
+    REQUIRE( rg::trace::label_name( a ) == "a" );
+    REQUIRE( rg::trace::label_name( 0 ) == "" );
+
+    // records only carry the id, the name is resolved when writing
+    std::string path = "redGrapes_test_trace_labels.json";
+    rg::trace::enable( path );
+    rg::trace::record_slow( rg::trace::EventKind::CREATE, 7, rg::trace::intern_label( "my \"task\"" ) );
+    rg::trace::record_slow( rg::trace::EventKind::START, 7 );
+    rg::trace::record_slow( rg::trace::EventKind::FINISH, 7 );
+    rg::trace::dump();
+
+    std::ifstream file( path );
+    std::stringstream buf;
+    buf << file.rdbuf();
+    std::string trace = buf.str();
+    std::remove( path.c_str() );
+
+    REQUIRE( count( trace, "\"name\":\"create my \\\"task\\\"\"" ) == 1 );
+    REQUIRE( count( trace, "\"name\":\"my \\\"task\\\"\",\"ph\":\"X\"" ) == 1 );
+}